@@ -0,0 +1,346 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for block-sparse matrix multiplication: A is pruned at tile granularity,
+* the host builds a tile occupancy bitmap and block-CSR from the dense matrix, and the kernel
+* skips every all-zero tile. Compared with the dense tiled kernel (matrix_localmem.cl).
+*
+* ICPX:    icpx blocksparse.cc -o blocksparse.exe -O2 -std=c++20 -lOpenCL
+* Usage:   blocksparse.exe -size=1024 -tile=16 (density sweep, as a sample)
+*          blocksparse.exe -size=2048 -density=10
+*
+* blocksparse.cl and matrix_localmem.cl are read from the same directory.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 1024;
+    unsigned int Tile = 16;
+    std::vector<unsigned int> densities = { 100, 50, 25, 10, 5, 1 }; // percent of nonzero tiles in A
+    std::string kernelPath = "blocksparse.cl";
+    std::string densePath = "matrix_localmem.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-tile=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Tile);
+            if (res.ec != std::errc{} || cfg.Tile == 0) {
+                std::cerr << "Invalid -tile value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-density=")) {
+            unsigned int density = 0;
+            auto res = std::from_chars(arg.data() + 9, arg.data() + arg.size(), density);
+            if (res.ec != std::errc{} || density > 100) {
+                std::cerr << "Invalid -density value (0..100 percent of nonzero tiles)\n";
+                std::exit(EXIT_FAILURE);
+            }
+            cfg.densities = { density };
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// BLOCK-SPARSE FORMAT
+
+struct BlockCsr {
+    unsigned int tile = 0;
+    unsigned int tilesPerSide = 0;
+    std::vector<unsigned char> occupancy;     // tilesPerSide^2 bitmap, one byte per tile
+    std::vector<unsigned int> blockRowPtr;    // tilesPerSide + 1
+    std::vector<unsigned int> blockColIdx;    // stored tiles
+    std::vector<float> blockVals;             // stored tiles * tile^2, row-major, zero-filled past the edge
+};
+
+// Pass 1 marks tiles holding any nonzero; pass 2 copies the marked tiles row of tiles by row of tiles
+void build_block_csr(const std::vector<float>& A, unsigned int N, unsigned int tile, BlockCsr& bsr) {
+    const unsigned int tiles = (N + tile - 1) / tile;
+    bsr.tile = tile;
+    bsr.tilesPerSide = tiles;
+    bsr.occupancy.assign(static_cast<size_t>(tiles) * tiles, 0);
+    for (unsigned int i = 0; i < N; ++i) {
+        for (unsigned int j = 0; j < N; ++j) {
+            if (A[static_cast<size_t>(i) * N + j] != 0.0f) bsr.occupancy[static_cast<size_t>(i / tile) * tiles + j / tile] = 1;
+        }
+    }
+
+    bsr.blockRowPtr.assign(tiles + 1, 0);
+    bsr.blockColIdx.clear();
+    bsr.blockVals.clear();
+    for (unsigned int tr = 0; tr < tiles; ++tr) {
+        for (unsigned int tc = 0; tc < tiles; ++tc) {
+            if (!bsr.occupancy[static_cast<size_t>(tr) * tiles + tc]) continue;
+            bsr.blockColIdx.push_back(tc);
+            for (unsigned int r = 0; r < tile; ++r) {
+                for (unsigned int c = 0; c < tile; ++c) {
+                    const unsigned int i = tr * tile + r;
+                    const unsigned int j = tc * tile + c;
+                    bsr.blockVals.push_back((i < N && j < N) ? A[static_cast<size_t>(i) * N + j] : 0.0f);
+                }
+            }
+        }
+        bsr.blockRowPtr[tr + 1] = static_cast<unsigned int>(bsr.blockColIdx.size());
+    }
+}
+
+// CPU matrix
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Tile-pruned A: every tile is kept with probability density / 100
+void prune_tiles(std::vector<float>& A, unsigned int N, unsigned int tile, unsigned int density) {
+    static std::mt19937_64 gen;
+    std::uniform_int_distribution<unsigned int> percent(0, 99);
+    const unsigned int tiles = (N + tile - 1) / tile;
+    for (unsigned int tr = 0; tr < tiles; ++tr) {
+        for (unsigned int tc = 0; tc < tiles; ++tc) {
+            if (percent(gen) < density) continue;
+            for (unsigned int i = tr * tile; i < std::min(N, (tr + 1) * tile); ++i)
+                for (unsigned int j = tc * tile; j < std::min(N, (tc + 1) * tile); ++j)
+                    A[static_cast<size_t>(i) * N + j] = 0.0f;
+        }
+    }
+}
+
+// Skips the same tiles as the device; i-k-j order keeps the inner loop contiguous
+void bsr_mult_ref(const BlockCsr& bsr, const float* B, float* C, unsigned int N) {
+    const unsigned int tile = bsr.tile;
+    std::fill(C, C + static_cast<size_t>(N) * N, 0.0f);
+    for (unsigned int tr = 0; tr < bsr.tilesPerSide; ++tr) {
+        for (unsigned int b = bsr.blockRowPtr[tr]; b < bsr.blockRowPtr[tr + 1]; ++b) {
+            const float* tileVals = &bsr.blockVals[static_cast<size_t>(b) * tile * tile];
+            const unsigned int k0 = bsr.blockColIdx[b] * tile;
+            for (unsigned int r = 0; r < tile && tr * tile + r < N; ++r) {
+                float* Crow = C + static_cast<size_t>(tr * tile + r) * N;
+                for (unsigned int kk = 0; kk < tile && k0 + kk < N; ++kk) {
+                    const float a = tileVals[r * tile + kk];
+                    const float* Brow = B + static_cast<size_t>(k0 + kk) * N;
+                    for (unsigned int j = 0; j < N; ++j) Crow[j] += a * Brow[j];
+                }
+            }
+        }
+    }
+}
+
+// Device sums are reordered by tiles: relative tolerance
+bool nearlyEqual(const std::vector<float>& gpu, const std::vector<float>& cpu) {
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        if (std::abs(gpu[i] - cpu[i]) > 1e-3f * std::abs(cpu[i]) + 1e-3f) return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+    const size_t matrixSize = static_cast<size_t>(N) * N;
+
+    std::cout << "Matrix size: " << N << " x " << N << "\n";
+    std::cout << "Tile size: " << cfg.Tile << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    const std::string defines = "#define TILE " + std::to_string(cfg.Tile) + "\n";
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice });
+    cl::Program denseProgram(context, defines + readKernelFile(cfg.densePath));
+    denseProgram.build({ selectedDevice });
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    std::vector<float> hostA(matrixSize);
+    std::vector<float> hostB(matrixSize);
+    std::vector<float> hostC_gpu(matrixSize);
+    std::vector<float> hostC_cpu(matrixSize);
+    rand_init(hostB, 0.0f, 10.0f);
+
+    cl::Buffer bufferA(context, CL_MEM_READ_ONLY, matrixSize * sizeof(float));
+    cl::Buffer bufferB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, matrixSize * sizeof(float), hostB.data());
+    cl::Buffer bufferC(context, CL_MEM_WRITE_ONLY, matrixSize * sizeof(float));
+
+    const size_t paddedN = (N + cfg.Tile - 1) / cfg.Tile * cfg.Tile;
+    const cl::NDRange globalSize(paddedN, paddedN);
+    const cl::NDRange localSize(cfg.Tile, cfg.Tile);
+
+    cl::Kernel denseKernel(denseProgram, "matrixmult");
+    denseKernel.setArg(0, bufferA);
+    denseKernel.setArg(1, bufferB);
+    denseKernel.setArg(2, bufferC);
+    denseKernel.setArg(3, N);
+
+    bool allCorrect = true;
+    std::cout << std::left << std::setw(10) << "density" << std::setw(14) << "tiles kept" << std::setw(12) << "build ms"
+        << std::setw(12) << "dense ms" << std::setw(12) << "sparse ms" << std::setw(10) << "speedup"
+        << std::setw(10) << "CPU ms" << "check\n";
+
+    for (unsigned int density : cfg.densities) {
+        rand_init(hostA, 0.0f, 10.0f);
+        prune_tiles(hostA, N, cfg.Tile, density);
+
+        BlockCsr bsr;
+        auto buildStart = std::chrono::high_resolution_clock::now();
+        build_block_csr(hostA, N, cfg.Tile, bsr);
+        auto buildEnd = std::chrono::high_resolution_clock::now();
+        double buildMs = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+        const size_t blocks = bsr.blockColIdx.size();
+
+        // empty A still gets valid buffers
+        cl::Buffer bufferRowPtr(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+            bsr.blockRowPtr.size() * sizeof(unsigned int), bsr.blockRowPtr.data());
+        cl::Buffer bufferColIdx(context, CL_MEM_READ_ONLY, std::max<size_t>(1, blocks) * sizeof(unsigned int));
+        cl::Buffer bufferVals(context, CL_MEM_READ_ONLY, std::max<size_t>(1, bsr.blockVals.size()) * sizeof(float));
+        if (blocks > 0) {
+            queue.enqueueWriteBuffer(bufferColIdx, CL_FALSE, 0, blocks * sizeof(unsigned int), bsr.blockColIdx.data());
+            queue.enqueueWriteBuffer(bufferVals, CL_FALSE, 0, bsr.blockVals.size() * sizeof(float), bsr.blockVals.data());
+        }
+        queue.enqueueWriteBuffer(bufferA, CL_FALSE, 0, matrixSize * sizeof(float), hostA.data());
+
+        auto cpuStart = std::chrono::high_resolution_clock::now();
+        bsr_mult_ref(bsr, hostB.data(), hostC_cpu.data(), N);
+        auto cpuEnd = std::chrono::high_resolution_clock::now();
+        double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+        cl::Event denseEvent;
+        queue.enqueueNDRangeKernel(denseKernel, cl::NullRange, globalSize, localSize, nullptr, &denseEvent);
+        queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, matrixSize * sizeof(float), hostC_gpu.data());
+        bool correct = nearlyEqual(hostC_gpu, hostC_cpu);
+
+        cl::Kernel sparseKernel(program, "matrixmult_bsr");
+        sparseKernel.setArg(0, bufferRowPtr);
+        sparseKernel.setArg(1, bufferColIdx);
+        sparseKernel.setArg(2, bufferVals);
+        sparseKernel.setArg(3, bufferB);
+        sparseKernel.setArg(4, bufferC);
+        sparseKernel.setArg(5, N);
+
+        cl::Event sparseEvent;
+        queue.enqueueNDRangeKernel(sparseKernel, cl::NullRange, globalSize, localSize, nullptr, &sparseEvent);
+        queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, matrixSize * sizeof(float), hostC_gpu.data());
+        correct = correct && nearlyEqual(hostC_gpu, hostC_cpu);
+        allCorrect = allCorrect && correct;
+
+        const cl_ulong denseNs = elapsedNs(denseEvent);
+        const cl_ulong sparseNs = elapsedNs(sparseEvent);
+        const double kept = 100.0 * blocks / bsr.occupancy.size();
+        std::cout << std::left << std::setw(10) << (std::to_string(density) + "%")
+            << std::setw(14) << (std::to_string(static_cast<int>(std::lround(kept))) + "% (" + std::to_string(blocks) + ")")
+            << std::setw(12) << buildMs << std::setw(12) << denseNs * 1e-6 << std::setw(12) << sparseNs * 1e-6
+            << std::setw(10) << static_cast<double>(denseNs) / sparseNs
+            << std::setw(10) << cpuTimeMs << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\nResult correctness: " << (allCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Block-sparse matrix multiplication completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* blocksparse OpenCL kernel
+*
+* C = A * B with A in block-CSR: TILE x TILE tiles, only the tiles holding a nonzero are stored.
+*   blockRowPtr[tileRows + 1] - range of stored tiles for every row of tiles
+*   blockColIdx[blocks]       - column of every stored tile, in tiles
+*   blockVals[blocks][TILE * TILE] - tile values, row-major, zero-filled past the matrix edge
+* B and C are dense N x N. The k loop of a work-group visits only the stored tiles of its tile row,
+* so all-zero tiles cost neither loads nor multiplies.
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+
+__kernel void matrixmult_bsr(__global const unsigned int* blockRowPtr,
+                             __global const unsigned int* blockColIdx,
+                             __global const float* blockVals,
+                             __global const float* B,
+                             __global float* C,
+                             const unsigned int N)
+{
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    const int row = get_group_id(1) * TILE + ty;
+    const int col = get_group_id(0) * TILE + tx;
+
+    __local float Asub[TILE][TILE];
+    __local float Bsub[TILE][TILE];
+
+    float sum = 0.0f;
+
+    // same bounds for the whole group: the barriers below are reached by every work-item
+    const unsigned int tileRow = get_group_id(1);
+    const unsigned int first = blockRowPtr[tileRow];
+    const unsigned int last = blockRowPtr[tileRow + 1];
+    for (unsigned int b = first; b < last; ++b) {
+        const int k = blockColIdx[b] * TILE;
+
+        // a stored tile is one contiguous TILE * TILE block
+        Asub[ty][tx] = blockVals[b * (TILE * TILE) + ty * TILE + tx];
+
+        if ((k + ty) < N && col < N) {
+            Bsub[ty][tx] = B[(k + ty) * N + col];
+        } else {
+            Bsub[ty][tx] = 0.0f;
+        }
+
+        // SYNC
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k_local = 0; k_local < TILE; ++k_local) {
+            sum += Asub[ty][k_local] * Bsub[k_local][tx];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < N && col < N) {
+        C[row * N + col] = sum;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,474 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for runtime fusion of elementwise expressions: operators on device arrays
+* build an expression tree (expression templates) instead of launching kernels. Evaluating the tree
+* generates one OpenCL kernel for the whole expression, and the compiled kernel is cached by the
+* generated source, so the same expression with other arrays or scalars is not rebuilt.
+* Compared with one vector_add-style kernel per operation, with every intermediate result going
+* through global memory.
+*
+* ICPX:    icpx fusion.cc -o fusion.exe -O2 -std=c++20 -lOpenCL
+* Usage:   fusion.exe -size=16777216 (as a sample)
+*          fusion.exe -size=1000000 -source
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <string>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 16'777'216;
+    bool source = false;        // print the generated kernels
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-source") {
+            cfg.source = true;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// JIT
+
+// A float array on the device; host keeps the input values for checking
+struct DeviceArray {
+    cl::Buffer buf;
+    std::vector<float> host;
+};
+
+// Kernel arguments collected while emitting an expression: every distinct array and every scalar
+// becomes a parameter, so scalar values never change the generated source
+struct Codegen {
+    std::vector<const DeviceArray*> arrays;
+    std::vector<float> scalars;
+
+    std::string array(const DeviceArray* a) {
+        auto it = std::find(arrays.begin(), arrays.end(), a);
+        if (it == arrays.end()) {
+            arrays.push_back(a);
+            it = arrays.end() - 1;
+        }
+        return "a" + std::to_string(it - arrays.begin()) + "[i]";
+    }
+
+    std::string scalar(float v) {
+        scalars.push_back(v);
+        return "s" + std::to_string(scalars.size() - 1);
+    }
+};
+
+class Jit {
+public:
+    Jit(const cl::Context& context, const cl::Device& device, cl::CommandQueue& queue, size_t n)
+        : context(context), device(device), queue(queue), n(n) {}
+
+    // out = e as one fused kernel
+    template<typename E>
+    void assign(DeviceArray& out, const E& e) {
+        Codegen cg;
+        const std::string body = e.emit(cg);
+        launch(out, body, cg);
+    }
+
+    // out = e with one kernel per operation, intermediates in temporaries
+    template<typename E>
+    void assignUnfused(DeviceArray& out, const E& e) {
+        tempsUsed = 0;
+        e.lower(*this, &out);
+    }
+
+    DeviceArray& temp() {
+        if (tempsUsed == temps.size()) {
+            temps.push_back({ cl::Buffer(context, CL_MEM_READ_WRITE, n * sizeof(float)), {} });
+        }
+        return temps[tempsUsed++];
+    }
+
+    void resetStats() {
+        events.clear();
+        bytes = 0;
+    }
+
+    cl_ulong kernelNs() const {
+        cl_ulong ns = 0;
+        for (const auto& e : events) ns += elapsedNs(e);
+        return ns;
+    }
+
+    size_t launches() const { return events.size(); }
+    double trafficBytes() const { return bytes; }
+
+    size_t builds = 0;
+    size_t hits = 0;
+    bool printSource = false;
+
+private:
+    cl::Context context;
+    cl::Device device;
+    cl::CommandQueue& queue;
+    size_t n;
+    std::unordered_map<std::string, cl::Kernel> cache;  // generated source -> kernel
+    std::deque<DeviceArray> temps;                      // stable addresses as the pool grows
+    size_t tempsUsed = 0;
+    std::vector<cl::Event> events;
+    double bytes = 0.0;
+
+    static std::string kernelSource(const std::string& body, const Codegen& cg) {
+        std::string src = "__kernel void fused(__global float* out";
+        for (size_t k = 0; k < cg.arrays.size(); ++k) src += ", __global const float* a" + std::to_string(k);
+        for (size_t k = 0; k < cg.scalars.size(); ++k) src += ", const float s" + std::to_string(k);
+        src += ", const unsigned int n) {\n"
+               "    const unsigned int i = get_global_id(0);\n"
+               "    if (i < n) {\n"
+               "        out[i] = " + body + ";\n"
+               "    }\n"
+               "}\n";
+        return src;
+    }
+
+    void launch(DeviceArray& out, const std::string& body, const Codegen& cg) {
+        const std::string src = kernelSource(body, cg);
+        auto it = cache.find(src);
+        if (it == cache.end()) {
+            cl::Program program(context, src);
+            program.build({ device });
+            it = cache.emplace(src, cl::Kernel(program, "fused")).first;
+            ++builds;
+            if (printSource) std::cout << src << "\n";
+        }
+        else {
+            ++hits;
+        }
+
+        cl::Kernel& kernel = it->second;
+        cl_uint arg = 0;
+        kernel.setArg(arg++, out.buf);
+        for (const DeviceArray* a : cg.arrays) kernel.setArg(arg++, a->buf);
+        for (float s : cg.scalars) kernel.setArg(arg++, s);
+        kernel.setArg(arg++, static_cast<cl_uint>(n));
+
+        const cl::NDRange globalSize((n + 255) / 256 * 256);
+        events.emplace_back();
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, cl::NDRange(256), nullptr, &events.back());
+        bytes += (cg.arrays.size() + 1.0) * n * sizeof(float);
+    }
+};
+
+// EXPRESSION TEMPLATES
+
+enum class BinOp { Add, Sub, Mul, Div, Max, Min };
+enum class UnOp { Neg, Exp, Sqrt };
+
+// Leaf: an array or a scalar
+struct Operand {
+    const DeviceArray* array = nullptr;
+    float value = 0.0f;
+
+    std::string emit(Codegen& cg) const { return array ? cg.array(array) : cg.scalar(value); }
+    float at(size_t i) const { return array ? array->host[i] : value; }
+    Operand lower(Jit&, DeviceArray*) const { return *this; }
+};
+
+template<typename L, typename R>
+struct Binary {
+    BinOp op;
+    L l;
+    R r;
+
+    std::string emit(Codegen& cg) const {
+        const std::string a = l.emit(cg);
+        const std::string b = r.emit(cg);
+        switch (op) {
+        case BinOp::Add: return "(" + a + " + " + b + ")";
+        case BinOp::Sub: return "(" + a + " - " + b + ")";
+        case BinOp::Mul: return "(" + a + " * " + b + ")";
+        case BinOp::Div: return "(" + a + " / " + b + ")";
+        case BinOp::Max: return "fmax(" + a + ", " + b + ")";
+        case BinOp::Min: return "fmin(" + a + ", " + b + ")";
+        }
+        return {};
+    }
+
+    float at(size_t i) const {
+        const float a = l.at(i);
+        const float b = r.at(i);
+        switch (op) {
+        case BinOp::Add: return a + b;
+        case BinOp::Sub: return a - b;
+        case BinOp::Mul: return a * b;
+        case BinOp::Div: return a / b;
+        case BinOp::Max: return std::fmax(a, b);
+        case BinOp::Min: return std::fmin(a, b);
+        }
+        return 0.0f;
+    }
+
+    // operands first, then this operation alone into dst or a temporary
+    Operand lower(Jit& jit, DeviceArray* dst) const {
+        const Operand a = l.lower(jit, nullptr);
+        const Operand b = r.lower(jit, nullptr);
+        DeviceArray& out = dst ? *dst : jit.temp();
+        jit.assign(out, Binary<Operand, Operand>{ op, a, b });
+        return { &out };
+    }
+};
+
+template<typename E>
+struct Unary {
+    UnOp op;
+    E e;
+
+    std::string emit(Codegen& cg) const {
+        const std::string a = e.emit(cg);
+        switch (op) {
+        case UnOp::Neg: return "(-" + a + ")";
+        case UnOp::Exp: return "exp(" + a + ")";
+        case UnOp::Sqrt: return "sqrt(" + a + ")";
+        }
+        return {};
+    }
+
+    float at(size_t i) const {
+        const float a = e.at(i);
+        switch (op) {
+        case UnOp::Neg: return -a;
+        case UnOp::Exp: return std::exp(a);
+        case UnOp::Sqrt: return std::sqrt(a);
+        }
+        return 0.0f;
+    }
+
+    Operand lower(Jit& jit, DeviceArray* dst) const {
+        const Operand a = e.lower(jit, nullptr);
+        DeviceArray& out = dst ? *dst : jit.temp();
+        jit.assign(out, Unary<Operand>{ op, a });
+        return { &out };
+    }
+};
+
+template<typename T> struct IsNode : std::false_type {};
+template<typename L, typename R> struct IsNode<Binary<L, R>> : std::true_type {};
+template<typename E> struct IsNode<Unary<E>> : std::true_type {};
+
+template<typename T>
+concept Node = IsNode<T>::value;
+
+// anything an operator accepts: a tree node, an array, or a scalar
+template<typename T>
+concept Arg = Node<T> || std::same_as<T, DeviceArray> || std::floating_point<T>;
+
+// two operator arguments, at least one of them on the device
+template<typename L, typename R>
+concept Args = Arg<L> && Arg<R> && !(std::floating_point<L> && std::floating_point<R>);
+
+inline Operand wrap(const DeviceArray& a) { return { &a, 0.0f }; }
+inline Operand wrap(float v) { return { nullptr, v }; }
+template<Node E> E wrap(const E& e) { return e; }
+
+template<typename L, typename R> requires Args<L, R>
+auto binary(BinOp op, const L& l, const R& r) {
+    return Binary<decltype(wrap(l)), decltype(wrap(r))>{ op, wrap(l), wrap(r) };
+}
+
+template<typename E> requires Args<E, E>
+auto unary(UnOp op, const E& e) {
+    return Unary<decltype(wrap(e))>{ op, wrap(e) };
+}
+
+template<typename L, typename R> requires Args<L, R> auto operator+(const L& l, const R& r) { return binary(BinOp::Add, l, r); }
+template<typename L, typename R> requires Args<L, R> auto operator-(const L& l, const R& r) { return binary(BinOp::Sub, l, r); }
+template<typename L, typename R> requires Args<L, R> auto operator*(const L& l, const R& r) { return binary(BinOp::Mul, l, r); }
+template<typename L, typename R> requires Args<L, R> auto operator/(const L& l, const R& r) { return binary(BinOp::Div, l, r); }
+template<typename E> requires Args<E, E> auto operator-(const E& e) { return unary(UnOp::Neg, e); }
+
+namespace fused {
+    template<typename L, typename R> requires Args<L, R> auto max(const L& l, const R& r) { return binary(BinOp::Max, l, r); }
+    template<typename L, typename R> requires Args<L, R> auto min(const L& l, const R& r) { return binary(BinOp::Min, l, r); }
+    template<typename E> requires Args<E, E> auto exp(const E& e) { return unary(UnOp::Exp, e); }
+    template<typename E> requires Args<E, E> auto sqrt(const E& e) { return unary(UnOp::Sqrt, e); }
+}
+
+// CPU
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+template<typename E>
+bool check(const std::vector<float>& gpu, const E& e) {
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        const float ref = e.at(i);
+        if (std::abs(gpu[i] - ref) > 1e-4f * std::abs(ref) + 1e-5f) return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const size_t N = cfg.N;
+
+    std::cout << "Vector size: " << N << " floats\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+    Jit jit(context, selectedDevice, queue, N);
+    jit.printSource = cfg.source;
+
+    auto makeArray = [&](float low, float high) {
+        DeviceArray a{ {}, std::vector<float>(N) };
+        rand_init(a.host, low, high);
+        a.buf = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, N * sizeof(float), a.host.data());
+        return a;
+    };
+    const DeviceArray A = makeArray(-1.0f, 1.0f);
+    const DeviceArray B = makeArray(-1.0f, 1.0f);
+    const DeviceArray C = makeArray(0.0f, 1.0f);
+    const DeviceArray D = makeArray(0.0f, 1.0f);
+    DeviceArray out{ cl::Buffer(context, CL_MEM_READ_WRITE, N * sizeof(float)), {} };
+    std::vector<float> result(N);
+
+    bool correct = true;
+
+    std::cout << std::left << std::setw(34) << "expression" << std::setw(10) << "variant" << std::setw(9) << "kernels"
+        << std::setw(11) << "ms" << std::setw(13) << "traffic MB" << std::setw(10) << "GB/s" << std::setw(15) << "effective GB/s"
+        << "check\n";
+
+    // effective GB/s counts only the unavoidable traffic: the inputs once and the result once
+    auto run = [&](const std::string& label, const auto& expr) {
+        Codegen args;
+        expr.emit(args);
+        const double minBytes = (args.arrays.size() + 1.0) * N * sizeof(float);
+
+        for (int fusedVariant = 1; fusedVariant >= 0; --fusedVariant) {
+            auto evaluate = [&] {
+                if (fusedVariant) jit.assign(out, expr);
+                else jit.assignUnfused(out, expr);
+            };
+            evaluate(); // warm-up: builds the kernels and allocates the temporaries
+            queue.finish();
+            jit.resetStats();
+            evaluate();
+            queue.finish();
+
+            const cl_ulong ns = jit.kernelNs();
+            queue.enqueueReadBuffer(out.buf, CL_TRUE, 0, N * sizeof(float), result.data());
+            const bool ok = check(result, expr);
+            correct = correct && ok;
+
+            std::cout << std::left << std::setw(34) << (fusedVariant ? label : "") << std::setw(10) << (fusedVariant ? "fused" : "unfused")
+                << std::setw(9) << jit.launches() << std::setw(11) << ns * 1e-6 << std::setw(13) << jit.trafficBytes() / (1024.0 * 1024.0)
+                << std::setw(10) << jit.trafficBytes() / ns << std::setw(15) << minBytes / ns << (ok ? "PASSED" : "FAILED") << "\n";
+        }
+    };
+
+    const float s = 0.5f;
+    run("max((A + B) * s, 0)", fused::max((A + B) * s, 0.0f));
+    run("A * B + C * D", A * B + C * D);
+    run("sqrt(A*A + B*B) - s * C", fused::sqrt(A * A + B * B) - s * C);
+    run("exp(-(A*A)) * B + C / (D + 1)", fused::exp(-(A * A)) * B + C / (D + 1.0f));
+
+    // another scalar and other arrays: same structure, same source, no rebuild
+    const size_t buildsBefore = jit.builds;
+    jit.assign(out, fused::max((C + D) * 2.0f, 0.0f));
+    queue.finish();
+    std::cout << "\nRe-evaluated with new operands: " << (jit.builds == buildsBefore ? "cache hit" : "rebuilt") << "\n";
+    std::cout << "Programs built:   " << jit.builds << ", cache hits: " << jit.hits << "\n";
+
+    std::cout << "\nResult correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Fused elementwise expressions completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,334 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for matrix-vector products Y = A * X and Y = A^T * X with a batch of vectors.
+* GEMV reads every element of A once and does two flops with it: the kernels are measured against
+* memory bandwidth, as a share of a device buffer copy and of the peak given by -peak.
+*
+* ICPX:    icpx gemv.cc -o gemv.exe -O2 -std=c++20 -lOpenCL
+* Usage:   gemv.exe -rows=8192 -cols=8192 -batch=1 (as a sample)
+*          gemv.exe -rows=16384 -cols=4096 -batch=4 -peak=560 (peak in GB/s from the device data sheet)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int Rows = 8192;
+    unsigned int Cols = 8192;
+    unsigned int Batch = 1;     // vectors per product, 1..8
+    unsigned int PeakGBs = 0;   // theoretical memory bandwidth; 0: not reported
+    std::string kernelPath = "gemv.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-rows=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Rows);
+            if (res.ec != std::errc{} || cfg.Rows == 0) {
+                std::cerr << "Invalid -rows value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-cols=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Cols);
+            if (res.ec != std::errc{} || cfg.Cols == 0) {
+                std::cerr << "Invalid -cols value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-batch=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.Batch);
+            if (res.ec != std::errc{} || cfg.Batch == 0 || cfg.Batch > 8) {
+                std::cerr << "Invalid -batch value (1..8)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-peak=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.PeakGBs);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -peak value (GB/s)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+bool hasSubGroups(const cl::Device& device) {
+    const std::string ext = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    return ext.find("cl_khr_subgroups") != std::string::npos || ext.find("cl_intel_subgroups") != std::string::npos;
+}
+
+// Sub-group built-ins are declared for OpenCL C 2.0 and later
+std::string buildOptions(const cl::Device& device) {
+    const std::string version = device.getInfo<CL_DEVICE_OPENCL_C_VERSION>(); // "OpenCL C x.y ..."
+    if (version.starts_with("OpenCL C 3")) return "-cl-std=CL3.0";
+    if (version.starts_with("OpenCL C 2")) return "-cl-std=CL2.0";
+    return "";
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+constexpr unsigned int GROUPS_PER_CU = 8; // persistent groups per compute unit
+constexpr unsigned int LANES = 32;        // work-items per row in gemv_n without sub-groups
+
+// CPU GEMV
+
+void rand_init(std::vector<float>& v) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Y = op(A) * X in double, with the sums of |a * x| that bound the rounding error
+void gemv_ref(const std::vector<float>& A, const std::vector<float>& X, std::vector<double>& Y, std::vector<double>& Yabs,
+    unsigned int rows, unsigned int cols, unsigned int batch, bool transposed) {
+    const unsigned int outLen = transposed ? cols : rows;
+    const unsigned int inLen = transposed ? rows : cols;
+    std::fill(Y.begin(), Y.end(), 0.0);
+    std::fill(Yabs.begin(), Yabs.end(), 0.0);
+    for (unsigned int b = 0; b < batch; ++b) {
+        for (unsigned int i = 0; i < rows; ++i) {
+            for (unsigned int j = 0; j < cols; ++j) {
+                const double a = A[static_cast<size_t>(i) * cols + j];
+                const unsigned int out = transposed ? j : i;
+                const unsigned int in = transposed ? i : j;
+                const double p = a * X[static_cast<size_t>(b) * inLen + in];
+                Y[static_cast<size_t>(b) * outLen + out] += p;
+                Yabs[static_cast<size_t>(b) * outLen + out] += std::abs(p);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int rows = cfg.Rows;
+    const unsigned int cols = cfg.Cols;
+    const unsigned int batch = cfg.Batch;
+    const size_t matrixBytes = static_cast<size_t>(rows) * cols * sizeof(float);
+
+    std::cout << "Matrix: " << rows << " x " << cols << ", batch " << batch << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n";
+
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const bool subGroups = hasSubGroups(selectedDevice);
+    std::cout << "A * x:   " << (subGroups ? "one sub-group per row" : "local-memory tree per row") << "\n";
+
+    std::string defines = "#define GROUP_SIZE " + std::to_string(groupSize) + "\n";
+    defines += "#define LANES " + std::to_string(LANES) + "\n";
+    defines += "#define BATCH " + std::to_string(batch) + "\n";
+    if (subGroups) defines += "#define SUBGROUPS\n";
+
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice }, subGroups ? buildOptions(selectedDevice).c_str() : "");
+
+    // A^T * x: enough row slabs to give every compute unit GROUPS_PER_CU groups
+    const size_t colGroups = (cols + groupSize - 1) / groupSize;
+    const size_t maxSlabs = (rows + groupSize - 1) / groupSize;
+    const size_t slabs = std::clamp<size_t>((computeUnits * GROUPS_PER_CU + colGroups - 1) / colGroups, 1, maxSlabs);
+    const unsigned int rowsPerSlab = static_cast<unsigned int>(((rows + slabs - 1) / slabs + groupSize - 1) / groupSize * groupSize);
+    const unsigned int usedSlabs = (rows + rowsPerSlab - 1) / rowsPerSlab;
+    std::cout << "A^T * x: " << colGroups << " column groups x " << usedSlabs << " row slabs\n\n";
+
+    std::vector<float> hostA(static_cast<size_t>(rows) * cols);
+    std::vector<float> hostXn(static_cast<size_t>(batch) * cols);   // A * x: vectors of cols
+    std::vector<float> hostXt(static_cast<size_t>(batch) * rows);   // A^T * x: vectors of rows
+    rand_init(hostA);
+    rand_init(hostXn);
+    rand_init(hostXt);
+
+    cl::Buffer bufferA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, matrixBytes, hostA.data());
+    cl::Buffer bufferXn(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, hostXn.size() * sizeof(float), hostXn.data());
+    cl::Buffer bufferXt(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, hostXt.size() * sizeof(float), hostXt.data());
+    cl::Buffer bufferYn(context, CL_MEM_WRITE_ONLY, static_cast<size_t>(batch) * rows * sizeof(float));
+    cl::Buffer bufferYt(context, CL_MEM_READ_WRITE, static_cast<size_t>(batch) * cols * sizeof(float));
+    cl::Buffer bufferPartial(context, CL_MEM_READ_WRITE, static_cast<size_t>(usedSlabs) * batch * cols * sizeof(float));
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    // Attainable bandwidth: a device-side copy of A reads and writes every byte once
+    cl::Buffer bufferCopy(context, CL_MEM_READ_WRITE, matrixBytes);
+    cl::Event copyEvent;
+    queue.enqueueCopyBuffer(bufferA, bufferCopy, 0, 0, matrixBytes, nullptr, &copyEvent);
+    queue.finish();
+    const double copyGBs = 2.0 * matrixBytes / elapsedNs(copyEvent);
+    std::cout << "Copy bandwidth:   " << copyGBs << " GB/s\n";
+    if (cfg.PeakGBs > 0) std::cout << "Peak bandwidth:   " << cfg.PeakGBs << " GB/s\n";
+    std::cout << "\n";
+
+    // A * x
+    cl::Kernel kernelN(program, "gemv_n");
+    kernelN.setArg(0, bufferA);
+    kernelN.setArg(1, bufferXn);
+    kernelN.setArg(2, bufferYn);
+    kernelN.setArg(3, rows);
+    kernelN.setArg(4, cols);
+    const size_t groupsN = std::min<size_t>(computeUnits * GROUPS_PER_CU, (static_cast<size_t>(rows) * LANES + groupSize - 1) / groupSize);
+
+    cl::Event eventN;
+    queue.enqueueNDRangeKernel(kernelN, cl::NullRange, cl::NDRange(groupsN * groupSize), cl::NDRange(groupSize), nullptr, &eventN);
+
+    // A^T * x
+    cl::Kernel kernelT(program, "gemv_t");
+    kernelT.setArg(0, bufferA);
+    kernelT.setArg(1, bufferXt);
+    kernelT.setArg(2, bufferPartial);
+    kernelT.setArg(3, rows);
+    kernelT.setArg(4, cols);
+    kernelT.setArg(5, rowsPerSlab);
+
+    cl::Kernel kernelSum(program, "gemv_t_sum");
+    kernelSum.setArg(0, bufferPartial);
+    kernelSum.setArg(1, bufferYt);
+    kernelSum.setArg(2, cols);
+    kernelSum.setArg(3, usedSlabs);
+
+    cl::Event eventT, eventSum;
+    queue.enqueueNDRangeKernel(kernelT, cl::NullRange, cl::NDRange(colGroups * groupSize, usedSlabs), cl::NDRange(groupSize, 1),
+        nullptr, &eventT);
+    const size_t sumItems = static_cast<size_t>(batch) * cols;
+    queue.enqueueNDRangeKernel(kernelSum, cl::NullRange, cl::NDRange((sumItems + groupSize - 1) / groupSize * groupSize),
+        cl::NDRange(groupSize), nullptr, &eventSum);
+    queue.finish();
+
+    std::vector<float> hostYn(static_cast<size_t>(batch) * rows);
+    std::vector<float> hostYt(static_cast<size_t>(batch) * cols);
+    queue.enqueueReadBuffer(bufferYn, CL_TRUE, 0, hostYn.size() * sizeof(float), hostYn.data());
+    queue.enqueueReadBuffer(bufferYt, CL_TRUE, 0, hostYt.size() * sizeof(float), hostYt.data());
+
+    bool allCorrect = true;
+    std::cout << std::left << std::setw(10) << "product" << std::setw(12) << "kernel ms" << std::setw(10) << "GB/s"
+        << std::setw(10) << "GFLOPS" << std::setw(10) << "of copy" << std::setw(10) << "of peak"
+        << std::setw(10) << "CPU ms" << "check\n";
+
+    for (bool transposed : { false, true }) {
+        const unsigned int outLen = transposed ? cols : rows;
+        const unsigned int inLen = transposed ? rows : cols;
+        std::vector<double> refY(static_cast<size_t>(batch) * outLen), refAbs(refY.size());
+
+        auto cpuStart = std::chrono::high_resolution_clock::now();
+        gemv_ref(hostA, transposed ? hostXt : hostXn, refY, refAbs, rows, cols, batch, transposed);
+        auto cpuEnd = std::chrono::high_resolution_clock::now();
+        double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+        const std::vector<float>& gpuY = transposed ? hostYt : hostYn;
+        bool correct = true;
+        for (size_t i = 0; i < gpuY.size() && correct; ++i) {
+            correct = std::abs(gpuY[i] - refY[i]) <= 1e-4 * refAbs[i] + 1e-6;
+        }
+        allCorrect = allCorrect && correct;
+
+        // A once, the vectors once each way
+        const cl_ulong kernelNs = transposed ? elapsedNs(eventT) + elapsedNs(eventSum) : elapsedNs(eventN);
+        const double bytes = static_cast<double>(matrixBytes) + static_cast<double>(batch) * (inLen + outLen) * sizeof(float);
+        const double gbs = bytes / kernelNs;
+        const double gflops = 2.0 * batch * static_cast<double>(rows) * cols / kernelNs;
+        std::cout << std::left << std::setw(10) << (transposed ? "A^T * x" : "A * x") << std::setw(12) << kernelNs * 1e-6
+            << std::setw(10) << gbs << std::setw(10) << gflops
+            << std::setw(10) << (std::to_string(static_cast<int>(100.0 * gbs / copyGBs)) + "%")
+            << std::setw(10) << (cfg.PeakGBs > 0 ? std::to_string(static_cast<int>(100.0 * gbs / cfg.PeakGBs)) + "%" : "-")
+            << std::setw(10) << cpuTimeMs << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\nResult correctness: " << (allCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Matrix-vector products computed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
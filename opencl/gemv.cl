@@ -0,0 +1,162 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* gemv OpenCL kernels
+*
+* Matrix-vector products with A rows x cols, row-major, and BATCH vectors stored one after another
+* (X[b * len + i], Y[b * len + i]); every element of A is read once for the whole batch:
+*   gemv_n     - Y = A * X: one sub-group per row (SUBGROUPS), else LANES work-items per row with a
+*                local tree; neighbouring lanes read neighbouring elements of the row
+*   gemv_t     - Y = A^T * X: one work-item per column, so a row of A is read contiguously across the
+*                group; X is staged in local memory GROUP_SIZE rows at a time; dimension 1 splits the
+*                rows into slabs and every slab writes its own partial sums
+*   gemv_t_sum - adds the slabs' partial sums
+*/
+
+/* #define GROUP_SIZE 256 */   /*for ocloc offline compilation*/
+/* #define LANES 32 */
+/* #define BATCH 1 */
+
+#ifdef SUBGROUPS
+
+__kernel void gemv_n(__global const float* A,
+                     __global const float* X,
+                     __global float* Y,
+                     uint rows,
+                     uint cols) {
+    const uint lanes = get_sub_group_size();
+    const uint lane = get_sub_group_local_id();
+    const uint stride = get_num_groups(0) * get_num_sub_groups();
+
+    // the loop bound is uniform across the sub-group, as sub_group_reduce_add requires
+    for (uint row = get_group_id(0) * get_num_sub_groups() + get_sub_group_id(); row < rows; row += stride) {
+        __global const float* a = A + (size_t)row * cols;
+        float acc[BATCH];
+        for (uint b = 0; b < BATCH; ++b) acc[b] = 0.0f;
+
+        for (uint j = lane; j < cols; j += lanes) {
+            const float v = a[j];
+            for (uint b = 0; b < BATCH; ++b) {
+                acc[b] = fma(v, X[b * cols + j], acc[b]);
+            }
+        }
+        for (uint b = 0; b < BATCH; ++b) {
+            acc[b] = sub_group_reduce_add(acc[b]);
+        }
+        if (lane == 0) {
+            for (uint b = 0; b < BATCH; ++b) {
+                Y[b * rows + row] = acc[b];
+            }
+        }
+    }
+}
+
+#else
+
+__kernel void gemv_n(__global const float* A,
+                     __global const float* X,
+                     __global float* Y,
+                     uint rows,
+                     uint cols) {
+    __local float partial[GROUP_SIZE];
+
+    const uint lid = get_local_id(0);
+    const uint lane = lid % LANES;
+    const uint rowsPerGroup = GROUP_SIZE / LANES;
+    const uint stride = get_num_groups(0) * rowsPerGroup;
+
+    // uniform bound across the group: every work-item reaches every barrier
+    for (uint base = get_group_id(0) * rowsPerGroup; base < rows; base += stride) {
+        const uint row = base + lid / LANES;
+        float acc[BATCH];
+        for (uint b = 0; b < BATCH; ++b) acc[b] = 0.0f;
+
+        if (row < rows) {
+            __global const float* a = A + (size_t)row * cols;
+            for (uint j = lane; j < cols; j += LANES) {
+                const float v = a[j];
+                for (uint b = 0; b < BATCH; ++b) {
+                    acc[b] = fma(v, X[b * cols + j], acc[b]);
+                }
+            }
+        }
+
+        for (uint b = 0; b < BATCH; ++b) {
+            partial[lid] = acc[b];
+            barrier(CLK_LOCAL_MEM_FENCE);
+            for (uint offset = LANES / 2; offset > 0; offset /= 2) {
+                if (lane < offset) {
+                    partial[lid] += partial[lid + offset];
+                }
+                barrier(CLK_LOCAL_MEM_FENCE);
+            }
+            if (lane == 0 && row < rows) {
+                Y[b * rows + row] = partial[lid];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+}
+
+#endif
+
+__kernel void gemv_t(__global const float* A,
+                     __global const float* X,
+                     __global float* partial,
+                     uint rows,
+                     uint cols,
+                     uint rowsPerSlab) {
+    __local float xs[BATCH * GROUP_SIZE];
+
+    const uint lid = get_local_id(0);
+    const uint col = get_global_id(0);
+    const uint slab = get_group_id(1);
+    const uint first = slab * rowsPerSlab;
+    const uint last = min(first + rowsPerSlab, rows);
+
+    float acc[BATCH];
+    for (uint b = 0; b < BATCH; ++b) acc[b] = 0.0f;
+
+    // uniform bounds across the group: every work-item reaches every barrier
+    for (uint r0 = first; r0 < last; r0 += GROUP_SIZE) {
+        const uint count = min((uint)GROUP_SIZE, last - r0);
+        if (lid < count) {
+            for (uint b = 0; b < BATCH; ++b) {
+                xs[b * GROUP_SIZE + lid] = X[b * rows + r0 + lid];
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (col < cols) {
+            __global const float* a = A + (size_t)r0 * cols + col;
+            for (uint r = 0; r < count; ++r) {
+                const float v = a[(size_t)r * cols];
+                for (uint b = 0; b < BATCH; ++b) {
+                    acc[b] = fma(v, xs[b * GROUP_SIZE + r], acc[b]); // same address for the whole group: broadcast
+                }
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (col < cols) {
+        for (uint b = 0; b < BATCH; ++b) {
+            partial[((size_t)slab * BATCH + b) * cols + col] = acc[b];
+        }
+    }
+}
+
+__kernel void gemv_t_sum(__global const float* partial,
+                         __global float* Y,
+                         uint cols,
+                         uint slabs) {
+    const uint i = get_global_id(0); // b * cols + col
+    if (i >= BATCH * cols) return;
+
+    float sum = 0.0f;
+    for (uint s = 0; s < slabs; ++s) {
+        sum += partial[(size_t)s * BATCH * cols + i];
+    }
+    Y[i] = sum;
+}
\ No newline at end of file
@@ -5,16 +5,33 @@
 * hist_atomic OpenCL kernel
 */
 
+/* #define BINS 256 */     /*for ocloc offline compilation*/
+/* #define DATA_T uint */  /* uchar, ushort or uint */
+
 #pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
 
-__kernel void histogram(__global const uint* input,
+// each work-item reads one 4-wide vector (uchar4/ushort4/uint4)
+__kernel void histogram(__global const DATA_T* input,
                         __global uint* hist,
                         uint n) {
-    uint gid = get_global_id(0);
-    if (gid >= n) return;
+    const size_t gid = get_global_id(0);
+    const size_t first = gid * 4; // in uint, gid * 4 wraps from 2^30 work-items on
+    if (first >= n) return;
+
+    if (first + 4 <= n) {
+        uint4 value = convert_uint4(vload4(gid, input));
+        if (value.x < BINS) atomic_inc(&hist[value.x]);
+        if (value.y < BINS) atomic_inc(&hist[value.y]);
+        if (value.z < BINS) atomic_inc(&hist[value.z]);
+        if (value.w < BINS) atomic_inc(&hist[value.w]);
+        return;
+    }
 
-    uint value = input[gid];
-    if (value < BINS) {
-        atomic_inc(&hist[value]);
+    // tail: the last n % 4 elements
+    for (size_t i = first; i < n; ++i) {
+        uint value = input[i];
+        if (value < BINS) {
+            atomic_inc(&hist[value]);
+        }
     }
 }
\ No newline at end of file
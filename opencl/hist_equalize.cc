@@ -0,0 +1,364 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for histogram equalization of 8-bit grayscale images, kept on the device:
+* histogram (hist_local.cl) -> CDF and lookup table -> remap, chained by events on one queue.
+*
+* ICPX:    icpx hist_equalize.cc -o hist_equalize.exe -O2 -std=c++20 -lOpenCL
+* Usage:   hist_equalize.exe -width=4096 -height=4096 (synthetic low-contrast image)
+*          hist_equalize.exe -input=photo.pgm -output=equalized.pgm
+*
+* Images are binary PGM (P5) with maxval <= 255.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int Width = 4096;
+    unsigned int Height = 4096;
+    std::string inputPath = "";
+    std::string outputPath = "";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-width=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.Width);
+            if (res.ec != std::errc{} || cfg.Width == 0) {
+                std::cerr << "Invalid -width value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-height=")) {
+            auto res = std::from_chars(arg.data() + 8, arg.data() + arg.size(), cfg.Height);
+            if (res.ec != std::errc{} || cfg.Height == 0) {
+                std::cerr << "Invalid -height value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-input=")) {
+            cfg.inputPath = std::string(arg.substr(7));
+        }
+        else if (arg.starts_with("-output=")) {
+            cfg.outputPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+// Binary PGM (P5): header tokens may be separated by any whitespace and '#' comments
+bool readPGM(const std::string& path, std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    auto token = [&]() {
+        std::string tok;
+        while (file >> tok && tok[0] == '#') {
+            std::string comment;
+            std::getline(file, comment);
+        }
+        return tok;
+    };
+    if (token() != "P5") return false;
+    unsigned int maxVal = 0;
+    try {
+        width = std::stoul(token());
+        height = std::stoul(token());
+        maxVal = std::stoul(token());
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    if (width == 0 || height == 0 || maxVal == 0 || maxVal > 255) return false;
+    file.get(); // single whitespace before the raster
+
+    pixels.resize(static_cast<size_t>(width) * height);
+    file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    return static_cast<size_t>(file.gcount()) == pixels.size();
+}
+
+bool writePGM(const std::string& path, const std::vector<unsigned char>& pixels, unsigned int width, unsigned int height) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file << "P5\n" << width << " " << height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    return static_cast<bool>(file);
+}
+
+constexpr unsigned int LEVELS = 256;       // grey levels of an 8-bit image
+constexpr unsigned int MAX_COPIES = 8;     // sub-histogram replicas per work-group in hist_local.cl
+constexpr unsigned int GROUPS_PER_CU = 2;  // persistent groups per compute unit
+
+// CPU equalization
+
+// Low-contrast test image: a gradient squeezed into levels [64, 128) plus noise
+void synth_image(std::vector<unsigned char>& img, unsigned int width, unsigned int height) {
+    static std::mt19937_64 gen;
+    std::normal_distribution<float> noise(0.0f, 4.0f);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            float v = 64.0f + 64.0f * (x + y) / (width + height) + noise(gen);
+            img[static_cast<size_t>(y) * width + x] = static_cast<unsigned char>(std::clamp(v, 64.0f, 127.0f));
+        }
+    }
+}
+
+// Same integer arithmetic as cdf_lut in hist_equalize.cl, so the results match exactly
+void equalize_ref(const unsigned char* input, unsigned char* output, size_t n) {
+    unsigned int hist[LEVELS] = {};
+    for (size_t i = 0; i < n; ++i) hist[input[i]]++;
+
+    unsigned int cdf[LEVELS];
+    unsigned int running = 0;
+    unsigned int cdfMin = 0;
+    for (unsigned int b = 0; b < LEVELS; ++b) {
+        running += hist[b];
+        cdf[b] = running;
+        if (cdfMin == 0) cdfMin = running;
+    }
+
+    unsigned char lut[LEVELS];
+    const unsigned long long denom = n - cdfMin;
+    for (unsigned int b = 0; b < LEVELS; ++b) {
+        if (denom == 0) {
+            lut[b] = static_cast<unsigned char>(b);
+        }
+        else {
+            const unsigned long long num = static_cast<unsigned long long>(cdf[b] > cdfMin ? cdf[b] - cdfMin : 0) * (LEVELS - 1);
+            lut[b] = static_cast<unsigned char>((num + denom / 2) / denom);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) output[i] = lut[input[i]];
+}
+
+double stageMs(const cl::Event& event) {
+    return (event.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+        - event.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1e-6;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+
+    std::vector<unsigned char> hostImage;
+    unsigned int Width = cfg.Width;
+    unsigned int Height = cfg.Height;
+    if (!cfg.inputPath.empty()) {
+        if (!readPGM(cfg.inputPath, hostImage, Width, Height)) {
+            std::cerr << "Failed to read binary PGM image: " << cfg.inputPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    else {
+        hostImage.resize(static_cast<size_t>(Width) * Height);
+        synth_image(hostImage, Width, Height);
+    }
+    const size_t pixels = static_cast<size_t>(Width) * Height;
+    if (pixels > 0xFFFFFFFFull) {
+        std::cerr << "Image too large: the kernels count pixels in 32 bits\n";
+        return EXIT_FAILURE;
+    }
+    const unsigned int N = static_cast<unsigned int>(pixels);
+
+    std::cout << "Image: " << (cfg.inputPath.empty() ? "synthetic" : cfg.inputPath)
+        << " (" << Width << " x " << Height << ")\n";
+    std::cout << "Kernel files: hist_local.cl, hist_equalize.cl\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    const size_t localMem = selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t maxGroupSize = selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    if (maxGroupSize < LEVELS) {
+        std::cerr << "cdf_lut needs work-groups of " << LEVELS << " work-items\n";
+        return EXIT_FAILURE;
+    }
+    const size_t groupSize = LEVELS;
+    const unsigned int copies = static_cast<unsigned int>(
+        std::min<size_t>(MAX_COPIES, localMem / ((LEVELS + 1) * sizeof(unsigned int))));
+
+    // The histogram stage is hist_local.cl specialised for uchar pixels; the later stages come after it
+    std::string kernelSource = readKernelFile("hist_local.cl") + "\n" + readKernelFile("hist_equalize.cl");
+    std::string defines = "#define BINS " + std::to_string(LEVELS) + "\n";
+    defines += "#define DATA_T uchar\n";
+    defines += "#define COPIES " + std::to_string(copies) + "\n";
+    kernelSource = defines + kernelSource;
+
+    cl::Program program(context, kernelSource);
+    program.build({ selectedDevice });
+
+    cl::Kernel histKernel(program, "histogram");
+    cl::Kernel lutKernel(program, "cdf_lut");
+    cl::Kernel remapKernel(program, "remap");
+
+    // Reference
+    std::vector<unsigned char> hostOutput_cpu(pixels);
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    equalize_ref(hostImage.data(), hostOutput_cpu.data(), pixels);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    cl::Buffer bufferInput(context, CL_MEM_READ_ONLY, pixels);
+    cl::Buffer bufferOutput(context, CL_MEM_WRITE_ONLY, pixels);
+    cl::Buffer bufferHist(context, CL_MEM_READ_WRITE, LEVELS * sizeof(unsigned int));
+    cl::Buffer bufferLut(context, CL_MEM_READ_WRITE, LEVELS);
+
+    histKernel.setArg(0, bufferInput);
+    histKernel.setArg(1, bufferHist);
+    histKernel.setArg(2, N);
+    lutKernel.setArg(0, bufferHist);
+    lutKernel.setArg(1, bufferLut);
+    lutKernel.setArg(2, N);
+    remapKernel.setArg(0, bufferInput);
+    remapKernel.setArg(1, bufferOutput);
+    remapKernel.setArg(2, bufferLut);
+    remapKernel.setArg(3, N);
+
+    const size_t numGroups = std::min((pixels + groupSize - 1) / groupSize, computeUnits * GROUPS_PER_CU);
+    const cl::NDRange global(numGroups * groupSize);
+    const cl::NDRange local(groupSize);
+
+    // Out-of-order queue: every stage names the events it depends on, nothing returns to the host in between
+    cl::CommandQueue queue(context, selectedDevice,
+        cl::QueueProperties::Profiling | cl::QueueProperties::OutOfOrder);
+
+    std::vector<unsigned char> hostOutput_gpu(pixels);
+    cl::Event writeEvent, fillEvent, histEvent, lutEvent, remapEvent, readEvent;
+
+    auto gpuWallStart = std::chrono::high_resolution_clock::now();
+    queue.enqueueWriteBuffer(bufferInput, CL_FALSE, 0, pixels, hostImage.data(), nullptr, &writeEvent);
+    queue.enqueueFillBuffer(bufferHist, 0u, 0, LEVELS * sizeof(unsigned int), nullptr, &fillEvent);
+
+    std::vector<cl::Event> histDeps{ writeEvent, fillEvent };
+    queue.enqueueNDRangeKernel(histKernel, cl::NullRange, global, local, &histDeps, &histEvent);
+
+    std::vector<cl::Event> lutDeps{ histEvent };
+    queue.enqueueNDRangeKernel(lutKernel, cl::NullRange, cl::NDRange(LEVELS), cl::NDRange(LEVELS),
+        &lutDeps, &lutEvent);
+
+    std::vector<cl::Event> remapDeps{ lutEvent };
+    queue.enqueueNDRangeKernel(remapKernel, cl::NullRange, global, local, &remapDeps, &remapEvent);
+
+    // Device to Host: only the equalized image
+    std::vector<cl::Event> readDeps{ remapEvent };
+    queue.enqueueReadBuffer(bufferOutput, CL_FALSE, 0, pixels, hostOutput_gpu.data(), &readDeps, &readEvent);
+    readEvent.wait();
+    auto gpuWallEnd = std::chrono::high_resolution_clock::now();
+    double gpuWallTimeMs = std::chrono::duration<double, std::milli>(gpuWallEnd - gpuWallStart).count();
+
+    // End to end on the device timeline: first upload start to readback end
+    const cl_ulong firstStart = std::min(writeEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>(),
+        fillEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+    const double deviceMs = (readEvent.getProfilingInfo<CL_PROFILING_COMMAND_END>() - firstStart) * 1e-6;
+    const double kernelMs = stageMs(histEvent) + stageMs(lutEvent) + stageMs(remapEvent);
+
+    std::cout << "Upload:           " << stageMs(writeEvent) << " ms\n";
+    std::cout << "Histogram:        " << stageMs(histEvent) << " ms\n";
+    std::cout << "CDF + LUT:        " << stageMs(lutEvent) << " ms\n";
+    std::cout << "Remap:            " << stageMs(remapEvent) << " ms\n";
+    std::cout << "Readback:         " << stageMs(readEvent) << " ms\n";
+    std::cout << "Kernels total:    " << kernelMs << " ms ("
+        << pixels / (kernelMs * 1e-3) / 1e6 << " Mpixel/s)\n";
+    std::cout << "End to end:       " << deviceMs << " ms device, " << gpuWallTimeMs << " ms wall\n";
+    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+
+    bool correct = (hostOutput_cpu == hostOutput_gpu);
+    std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+
+    if (!cfg.outputPath.empty()) {
+        if (!writePGM(cfg.outputPath, hostOutput_gpu, Width, Height)) {
+            std::cerr << "Failed to write image: " << cfg.outputPath << "\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Wrote " << cfg.outputPath << "\n";
+    }
+    std::cout << "\ndone. Image equalized.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
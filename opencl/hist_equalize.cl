@@ -0,0 +1,77 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_equalize OpenCL kernels
+*
+* Histogram equalization of 8-bit images, stages after the histogram (hist_local.cl):
+*   cdf_lut - prefix sum of the 256 bins into a CDF and the remapping table
+*   remap   - per-pixel lookup
+*/
+
+/* #define BINS 256 */   /*for ocloc offline compilation*/
+
+// One work-group of BINS work-items: Hillis-Steele inclusive scan in local memory
+__kernel void cdf_lut(__global const uint* hist,
+                      __global uchar* lut,
+                      uint pixels) {
+    __local uint cdf[BINS];
+    __local uint cdfMin;
+
+    const uint lid = get_local_id(0);
+
+    cdf[lid] = hist[lid];
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint offset = 1; offset < BINS; offset *= 2) {
+        uint add = (lid >= offset) ? cdf[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        cdf[lid] += add;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // CDF of the darkest level present: the first non-zero entry
+    if (lid == 0) {
+        cdfMin = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (cdf[lid] != 0 && (lid == 0 || cdf[lid - 1] == 0)) {
+        cdfMin = cdf[lid];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // lut = round((cdf - cdfMin) * 255 / (pixels - cdfMin)), in integers
+    const ulong denom = pixels - cdfMin;
+    if (denom == 0) {
+        lut[lid] = (uchar)lid; // a single grey level: nothing to stretch
+    }
+    else {
+        // levels below the darkest one have cdf == 0 and map to 0
+        const ulong num = (ulong)(cdf[lid] > cdfMin ? cdf[lid] - cdfMin : 0) * (BINS - 1);
+        lut[lid] = (uchar)((num + denom / 2) / denom);
+    }
+}
+
+__kernel void remap(__global const uchar* input,
+                    __global uchar* output,
+                    __global const uchar* lut,
+                    uint n) {
+    __local uchar localLut[BINS];
+
+    for (uint b = get_local_id(0); b < BINS; b += get_local_size(0)) {
+        localLut[b] = lut[b];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // grid-stride loop over uchar4 vectors
+    const size_t nVec = n / 4;
+    for (size_t i = get_global_id(0); i < nVec; i += get_global_size(0)) {
+        uchar4 p = vload4(i, input);
+        vstore4((uchar4)(localLut[p.x], localLut[p.y], localLut[p.z], localLut[p.w]), i, output);
+    }
+
+    // tail: the last n % 4 pixels
+    for (size_t i = nVec * 4 + get_global_id(0); i < n; i += get_global_size(0)) {
+        output[i] = localLut[input[i]];
+    }
+}
\ No newline at end of file
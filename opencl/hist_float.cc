@@ -0,0 +1,397 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for histograms of float data, binned on the GPU.
+*
+* ICPX:    icpx hist_float.cc -o hist_float.exe -O2 -std=c++20 -lOpenCL
+* Usage:   hist_float.exe -kernel=hist_float.cl -mode=uniform -min=0 -max=10 -size=67108864 (as a sample)
+*          hist_float.exe -mode=log -auto (bins over the data's own [min, max], found on the device)
+*          hist_float.exe -mode=edges -edges=edges.txt (BINS + 1 ascending edges, whitespace separated)
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+enum class BinMode { Uniform = 0, Log = 1, Edges = 2 }; // MODE in hist_float.cl
+
+struct Config {
+    unsigned int N = 16'777'216;
+    unsigned int Bins = 256;
+    BinMode mode = BinMode::Uniform;
+    float Min = 0.0f;
+    float Max = 10.0f;
+    bool autoRange = false;
+    std::string edgesPath = "";
+    std::string kernelPath = "hist_float.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-bins=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Bins);
+            if (res.ec != std::errc{} || cfg.Bins == 0) {
+                std::cerr << "Invalid -bins value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-mode=")) {
+            std::string_view mode = arg.substr(6);
+            if (mode == "uniform") cfg.mode = BinMode::Uniform;
+            else if (mode == "log") cfg.mode = BinMode::Log;
+            else if (mode == "edges") cfg.mode = BinMode::Edges;
+            else {
+                std::cerr << "Invalid -mode value (uniform|log|edges)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-min=")) {
+            auto res = std::from_chars(arg.data() + 5, arg.data() + arg.size(), cfg.Min);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -min value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-max=")) {
+            auto res = std::from_chars(arg.data() + 5, arg.data() + arg.size(), cfg.Max);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -max value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-auto") {
+            cfg.autoRange = true;
+        }
+        else if (arg.starts_with("-edges=")) {
+            cfg.edgesPath = std::string(arg.substr(7));
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+std::vector<float> readEdgesFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open edges file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<float> edges;
+    float edge;
+    while (file >> edge) edges.push_back(edge);
+    return edges;
+}
+
+// Quadratically spaced edges over [lo, hi]: fine bins at the low end
+std::vector<float> makeEdges(unsigned int bins, float lo, float hi) {
+    std::vector<float> edges(bins + 1);
+    for (unsigned int b = 0; b <= bins; ++b) {
+        float t = static_cast<float>(b) / bins;
+        edges[b] = lo + (hi - lo) * t * t;
+    }
+    edges[bins] = hi;
+    return edges;
+}
+
+constexpr unsigned int GROUPS_PER_CU = 2; // persistent groups per compute unit
+
+// CPU histogram
+
+// Log-normal data: latencies and similar positive, long-tailed values
+void rand_init(std::vector<float>& v) {
+    static std::mt19937_64 gen;
+    std::lognormal_distribution<float> dist(0.0f, 1.0f);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Same binning rules and float arithmetic as histogram_float in hist_float.cl
+void histogram_float_ref(const float* data, unsigned int* hist, unsigned int N, unsigned int bins,
+    BinMode mode, float lo, float hi, bool inclusiveHi, const std::vector<float>& edges) {
+    std::fill(hist, hist + bins, 0);
+    const float logSpan = std::log(hi) - std::log(lo);
+    const float scale = (mode == BinMode::Log)
+        ? ((logSpan > 0.0f) ? bins / logSpan : 0.0f)
+        : bins / (hi - lo);
+    const float logLo = (mode == BinMode::Log) ? std::log(lo) : 0.0f;
+
+    for (unsigned int i = 0; i < N; ++i) {
+        const float x = data[i];
+        if (!(x >= lo && (inclusiveHi ? x <= hi : x < hi))) continue;
+
+        unsigned int bin = 0;
+        if (mode == BinMode::Uniform) {
+            bin = std::min(static_cast<unsigned int>((x - lo) * scale), bins - 1);
+        }
+        else if (mode == BinMode::Log) {
+            bin = std::min(static_cast<unsigned int>((std::log(x) - logLo) * scale), bins - 1);
+        }
+        else {
+            bin = static_cast<unsigned int>(std::upper_bound(edges.begin(), edges.end() - 1, x) - edges.begin()) - 1;
+        }
+        hist[bin]++;
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+    const unsigned int Bins = cfg.Bins;
+    const char* modeName[] = { "uniform", "log", "edges" };
+
+    if (cfg.autoRange && cfg.mode == BinMode::Edges) {
+        std::cerr << "-auto applies to uniform and log bins only\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<float> hostEdges;
+    if (cfg.mode == BinMode::Edges) {
+        hostEdges = cfg.edgesPath.empty() ? makeEdges(Bins, cfg.Min, cfg.Max) : readEdgesFile(cfg.edgesPath);
+        if (hostEdges.size() != Bins + 1 || !std::is_sorted(hostEdges.begin(), hostEdges.end())) {
+            std::cerr << "Expected " << Bins + 1 << " ascending bin edges\n";
+            return EXIT_FAILURE;
+        }
+        cfg.Min = hostEdges.front();
+        cfg.Max = hostEdges.back();
+    }
+
+    std::cout << "Input size: " << N << "\n";
+    std::cout << "Histogram bins: " << Bins << " (" << modeName[static_cast<int>(cfg.mode)] << ")\n";
+    if (cfg.autoRange) {
+        std::cout << "Range: auto\n";
+    }
+    else {
+        std::cout << "Range: [" << cfg.Min << ", " << cfg.Max << ")\n";
+    }
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    if (!cfg.autoRange && !(cfg.Min < cfg.Max)) {
+        std::cerr << "Invalid range: -min must be below -max\n";
+        return EXIT_FAILURE;
+    }
+    if (!cfg.autoRange && cfg.mode == BinMode::Log && cfg.Min <= 0.0f) {
+        std::cerr << "Log bins need -min > 0\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
+    std::string defines = "#define BINS " + std::to_string(Bins) + "\n";
+    defines += "#define MODE " + std::to_string(static_cast<int>(cfg.mode)) + "\n";
+    if (cfg.autoRange || cfg.mode == BinMode::Edges) {
+        defines += "#define INCLUSIVE_HI\n";
+    }
+    kernelSource = defines + kernelSource;
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    const size_t localNeeded = Bins * sizeof(unsigned int) + (cfg.mode == BinMode::Edges ? (Bins + 1) * sizeof(float) : 0);
+    if (localNeeded > selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>()) {
+        std::cerr << "Bins do not fit in local memory.\n";
+        return EXIT_FAILURE;
+    }
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const size_t numGroups = std::min((N + groupSize - 1) / groupSize, computeUnits * GROUPS_PER_CU);
+
+    std::vector<float> hostData(N);
+    std::vector<unsigned int> hostHist_gpu(Bins, 0);
+    std::vector<unsigned int> hostHist_cpu(Bins, 0);
+
+    rand_init(hostData);
+    if (hostEdges.empty()) hostEdges.assign(1, 0.0f); // the kernel argument still needs a buffer
+
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    float cpuLo = cfg.Min;
+    float cpuHi = cfg.Max;
+    if (cfg.autoRange) {
+        auto [lo, hi] = std::minmax_element(hostData.begin(), hostData.end());
+        cpuLo = *lo;
+        cpuHi = (*hi > *lo) ? *hi : std::nextafter(*lo, INFINITY); // as minmax_final
+    }
+    if (cfg.autoRange && cfg.mode == BinMode::Log && cpuLo <= 0.0f) {
+        std::cerr << "Log bins need data > 0, the minimum is " << cpuLo << "\n";
+        return EXIT_FAILURE;
+    }
+    histogram_float_ref(hostData.data(), hostHist_cpu.data(), N, Bins, cfg.mode, cpuLo, cpuHi,
+        cfg.autoRange || cfg.mode == BinMode::Edges, hostEdges);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    long cpuTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuEnd - cpuStart).count();
+
+    float hostRange[2] = { cfg.Min, cfg.Max };
+    cl::Buffer bufferData(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        N * sizeof(float), hostData.data());
+    cl::Buffer bufferRange(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        2 * sizeof(float), hostRange);
+    cl::Buffer bufferEdges(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        hostEdges.size() * sizeof(float), hostEdges.data());
+    cl::Buffer bufferPartial(context, CL_MEM_READ_WRITE, numGroups * 2 * sizeof(float));
+    cl::Buffer bufferHist(context, CL_MEM_READ_WRITE, Bins * sizeof(unsigned int));
+
+    // In-order queue: min/max passes, then the histogram
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    queue.enqueueFillBuffer(bufferHist, 0u, 0, Bins * sizeof(unsigned int));
+
+    cl::Program program(context, kernelSource);
+    program.build({ selectedDevice });
+
+    cl::Kernel partialKernel(program, "minmax_partial");
+    partialKernel.setArg(0, bufferData);
+    partialKernel.setArg(1, bufferPartial);
+    partialKernel.setArg(2, N);
+    partialKernel.setArg(3, cl::Local(groupSize * sizeof(float)));
+    partialKernel.setArg(4, cl::Local(groupSize * sizeof(float)));
+
+    cl::Kernel finalKernel(program, "minmax_final");
+    finalKernel.setArg(0, bufferPartial);
+    finalKernel.setArg(1, static_cast<cl_uint>(numGroups));
+    finalKernel.setArg(2, bufferRange);
+    finalKernel.setArg(3, cl::Local(groupSize * sizeof(float)));
+    finalKernel.setArg(4, cl::Local(groupSize * sizeof(float)));
+
+    cl::Kernel histKernel(program, "histogram_float");
+    histKernel.setArg(0, bufferData);
+    histKernel.setArg(1, bufferHist);
+    histKernel.setArg(2, N);
+    histKernel.setArg(3, bufferRange);
+    histKernel.setArg(4, bufferEdges);
+
+    cl::NDRange globalSize(numGroups * groupSize);
+    cl::NDRange localSize(groupSize);
+
+    auto gpuWallStart = std::chrono::high_resolution_clock::now();
+    cl::Event partialEvent, finalEvent, histEvent;
+    if (cfg.autoRange) {
+        queue.enqueueNDRangeKernel(partialKernel, cl::NullRange, globalSize, localSize, nullptr, &partialEvent);
+        queue.enqueueNDRangeKernel(finalKernel, cl::NullRange, localSize, localSize, nullptr, &finalEvent);
+    }
+    queue.enqueueNDRangeKernel(histKernel, cl::NullRange, globalSize, localSize, nullptr, &histEvent);
+    queue.finish();
+    auto gpuWallEnd = std::chrono::high_resolution_clock::now();
+    long gpuWallTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(gpuWallEnd - gpuWallStart).count();
+
+    cl::copy(queue, bufferHist, hostHist_gpu.begin(), hostHist_gpu.end());
+
+    cl_ulong histNs = histEvent.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+        - histEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    cl_ulong rangeNs = 0;
+    if (cfg.autoRange) {
+        cl::copy(queue, bufferRange, hostRange, hostRange + 2);
+        rangeNs = finalEvent.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+            - partialEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        std::cout << "Auto range:       [" << hostRange[0] << ", " << hostRange[1] << "]"
+            << ((hostRange[0] == cpuLo && hostRange[1] == cpuHi) ? "" : " (differs from CPU)") << "\n";
+        std::cout << "GPU min/max time: " << rangeNs / 1'000'000 << " ms\n";
+    }
+
+    std::cout << "GPU wall time:    " << gpuWallTimeMs << " ms\n";
+    std::cout << "GPU kernel time:  " << histNs / 1'000'000 << " ms\n";
+    std::cout << "GPU throughput:   " << N / (static_cast<double>(histNs + rangeNs) * 1e-9) / 1e6 << " Melem/s\n";
+    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+
+    // Device division and log() may differ from the host's in the last bits (OpenCL allows a few ulp):
+    // allow a few elements on bin boundaries. Edges only compare, so they must match exactly.
+    unsigned long long moved = 0;
+    for (unsigned int i = 0; i < Bins; ++i) {
+        moved += (hostHist_cpu[i] > hostHist_gpu[i]) ? hostHist_cpu[i] - hostHist_gpu[i] : hostHist_gpu[i] - hostHist_cpu[i];
+    }
+    moved /= 2;
+    const bool correct = (cfg.mode == BinMode::Edges) ? moved == 0 : moved <= N / 100'000 + 1;
+    std::cout << "Elements in other bins than CPU: " << moved << "\n";
+    std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+    std::cout << "\ndone. Histogram computed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_float OpenCL kernels
+*
+* Histogram of float data binned on the device:
+*   MODE 0 - uniform bins over [lo, hi)
+*   MODE 1 - log-scale bins over [lo, hi), lo > 0
+*   MODE 2 - bin b covers [edges[b], edges[b + 1]), binary search in local memory
+* range[0] = lo and range[1] = hi come from the host or from the min/max pre-pass;
+* with INCLUSIVE_HI the maximum itself falls into the last bin.
+* The pre-pass widens hi by one ulp when all values are equal, so hi - lo is never zero.
+* Values outside the range and NaNs are not counted.
+*/
+
+/* #define BINS 256 */   /*for ocloc offline compilation*/
+/* #define MODE 0 */
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
+
+// Auto-ranging, pass 1: min and max of every group's grid-stride slice
+__kernel void minmax_partial(__global const float* input,
+                             __global float2* partial,
+                             uint n,
+                             __local float* lmin,
+                             __local float* lmax) {
+    const uint lid = get_local_id(0);
+
+    float vmin = INFINITY;
+    float vmax = -INFINITY;
+    for (size_t i = get_global_id(0); i < n; i += get_global_size(0)) {
+        float x = input[i];
+        vmin = fmin(vmin, x); // fmin/fmax skip NaNs
+        vmax = fmax(vmax, x);
+    }
+    lmin[lid] = vmin;
+    lmax[lid] = vmax;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // power-of-two local size
+    for (uint s = get_local_size(0) / 2; s > 0; s /= 2) {
+        if (lid < s) {
+            lmin[lid] = fmin(lmin[lid], lmin[lid + s]);
+            lmax[lid] = fmax(lmax[lid], lmax[lid + s]);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (lid == 0) {
+        partial[get_group_id(0)] = (float2)(lmin[0], lmax[0]);
+    }
+}
+
+// Auto-ranging, pass 2: a single group folds the partials into range[0..1]
+__kernel void minmax_final(__global const float2* partial,
+                           uint count,
+                           __global float* range,
+                           __local float* lmin,
+                           __local float* lmax) {
+    const uint lid = get_local_id(0);
+
+    float vmin = INFINITY;
+    float vmax = -INFINITY;
+    for (uint i = lid; i < count; i += get_local_size(0)) {
+        vmin = fmin(vmin, partial[i].x);
+        vmax = fmax(vmax, partial[i].y);
+    }
+    lmin[lid] = vmin;
+    lmax[lid] = vmax;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint s = get_local_size(0) / 2; s > 0; s /= 2) {
+        if (lid < s) {
+            lmin[lid] = fmin(lmin[lid], lmin[lid + s]);
+            lmax[lid] = fmax(lmax[lid], lmax[lid + s]);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (lid == 0) {
+        range[0] = lmin[0];
+        range[1] = (lmax[0] > lmin[0]) ? lmax[0] : nextafter(lmin[0], INFINITY);
+    }
+}
+
+__kernel void histogram_float(__global const float* input,
+                              __global uint* hist,
+                              uint n,
+                              __global const float* range,
+                              __global const float* edges) {
+    __local uint subHist[BINS];
+#if MODE == 2
+    __local float localEdges[BINS + 1];
+#endif
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+
+    for (uint b = lid; b < BINS; b += lsize) {
+        subHist[b] = 0;
+    }
+#if MODE == 2
+    for (uint b = lid; b <= BINS; b += lsize) {
+        localEdges[b] = edges[b];
+    }
+#endif
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    const float lo = range[0];
+    const float hi = range[1];
+#if MODE == 0
+    const float scale = BINS / (hi - lo);
+#elif MODE == 1
+    const float logLo = log(lo);
+    const float logSpan = log(hi) - logLo; // one ulp apart, lo and hi can still have the same log
+    const float scale = (logSpan > 0.0f) ? BINS / logSpan : 0.0f;
+#endif
+
+    for (size_t i = get_global_id(0); i < n; i += get_global_size(0)) {
+        const float x = input[i];
+#ifdef INCLUSIVE_HI
+        if (!(x >= lo && x <= hi)) continue; // also drops NaNs
+#else
+        if (!(x >= lo && x < hi)) continue;
+#endif
+
+#if MODE == 0
+        uint bin = min((uint)((x - lo) * scale), (uint)(BINS - 1));
+#elif MODE == 1
+        uint bin = min((uint)((log(x) - logLo) * scale), (uint)(BINS - 1));
+#else
+        // largest b with localEdges[b] <= x
+        uint left = 0;
+        uint right = BINS;
+        while (right - left > 1) {
+            uint mid = (left + right) / 2;
+            if (localEdges[mid] <= x) left = mid;
+            else right = mid;
+        }
+        uint bin = left;
+#endif
+        atomic_inc(&subHist[bin]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint b = lid; b < BINS; b += lsize) {
+        if (subHist[b] != 0) {
+            atomic_add(&hist[b], subHist[b]);
+        }
+    }
+}
\ No newline at end of file
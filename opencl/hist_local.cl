@@ -0,0 +1,65 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_local OpenCL kernel
+*
+* Each work-group accumulates into private sub-histograms in local memory
+* and merges them into the global histogram once at the end.
+*/
+
+/* #define BINS 256 */   /*for ocloc offline compilation*/
+/* #define COPIES 4 */
+/* #define DATA_T uint */    /* uchar, ushort or uint */
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
+
+#define STRIDE (BINS + 1) // padding: the same bin of neighbouring copies falls into different banks
+
+__kernel void histogram(__global const DATA_T* input,
+                        __global uint* hist,
+                        uint n) {
+    __local uint subHist[COPIES * STRIDE];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+
+    for (uint i = lid; i < COPIES * STRIDE; i += lsize) {
+        subHist[i] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // neighbouring lanes of a sub-group update different copies
+    __local uint* myHist = subHist + (lid % COPIES) * STRIDE;
+
+    // grid-stride loop over 4-wide vectors: the grid is sized to the device, not to n
+    const size_t nVec = n / 4;
+    for (size_t i = get_global_id(0); i < nVec; i += get_global_size(0)) {
+        uint4 value = convert_uint4(vload4(i, input));
+        if (value.x < BINS) atomic_inc(&myHist[value.x]);
+        if (value.y < BINS) atomic_inc(&myHist[value.y]);
+        if (value.z < BINS) atomic_inc(&myHist[value.z]);
+        if (value.w < BINS) atomic_inc(&myHist[value.w]);
+    }
+
+    // tail: the last n % 4 elements
+    for (size_t i = nVec * 4 + get_global_id(0); i < n; i += get_global_size(0)) {
+        uint value = input[i];
+        if (value < BINS) {
+            atomic_inc(&myHist[value]);
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // merge: one global atomic per bin per work-group
+    for (uint b = lid; b < BINS; b += lsize) {
+        uint sum = 0;
+        for (uint c = 0; c < COPIES; ++c) {
+            sum += subHist[c * STRIDE + b];
+        }
+        if (sum != 0) {
+            atomic_add(&hist[b], sum);
+        }
+    }
+}
\ No newline at end of file
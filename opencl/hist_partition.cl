@@ -0,0 +1,124 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_partition OpenCL kernels
+*
+* Histogram for bin counts that do not fit in local memory. The bin range is
+* split into RANGES ranges of RANGE_BINS bins each:
+*   1. range_count     - count elements per range
+*   2. range_scatter   - bucket the elements by range (order inside a bucket is arbitrary)
+*   3. range_histogram - local-memory histogram of every bucket
+*/
+
+/* #define BINS 1048576 */   /*for ocloc offline compilation*/
+/* #define RANGE_BINS 8192 */
+/* #define RANGES 128 */
+/* #define ITEMS 8 */
+/* #define DATA_T uint */        /* uchar, ushort or uint */
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
+
+__kernel void range_count(__global const DATA_T* input,
+                          __global uint* rangeCount,
+                          uint n) {
+    __local uint localCount[RANGES];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+
+    for (uint r = lid; r < RANGES; r += lsize) {
+        localCount[r] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (size_t i = get_global_id(0); i < n; i += get_global_size(0)) {
+        uint value = input[i];
+        if (value < BINS) {
+            atomic_inc(&localCount[value / RANGE_BINS]);
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint r = lid; r < RANGES; r += lsize) {
+        if (localCount[r] != 0) {
+            atomic_add(&rangeCount[r], localCount[r]);
+        }
+    }
+}
+
+// cursor[r] starts at the first slot of bucket r (exclusive scan of rangeCount)
+__kernel void range_scatter(__global const DATA_T* input,
+                            __global DATA_T* buckets,
+                            __global uint* cursor,
+                            uint n) {
+    __local uint localCount[RANGES];
+    __local uint localBase[RANGES];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    const size_t chunk = (size_t)lsize * ITEMS;
+
+    for (size_t base = get_group_id(0) * chunk; base < n; base += get_num_groups(0) * chunk) {
+        for (uint r = lid; r < RANGES; r += lsize) {
+            localCount[r] = 0;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // slot of every element inside its range for this chunk
+        uint value[ITEMS];
+        uint slot[ITEMS];
+        for (uint j = 0; j < ITEMS; ++j) {
+            size_t i = base + j * lsize + lid;
+            value[j] = (i < n) ? input[i] : BINS;
+            if (value[j] < BINS) {
+                slot[j] = atomic_inc(&localCount[value[j] / RANGE_BINS]);
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // one global atomic per range reserves space for the whole chunk
+        for (uint r = lid; r < RANGES; r += lsize) {
+            localBase[r] = (localCount[r] != 0) ? atomic_add(&cursor[r], localCount[r]) : 0;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (uint j = 0; j < ITEMS; ++j) {
+            if (value[j] < BINS) {
+                buckets[localBase[value[j] / RANGE_BINS] + slot[j]] = (DATA_T)value[j];
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
+
+// 2D grid: dimension 0 - groups sharing one bucket, dimension 1 - range index
+__kernel void range_histogram(__global const DATA_T* buckets,
+                              __global const uint* rangeStart,
+                              __global uint* hist) {
+    __local uint subHist[RANGE_BINS];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    const uint range = get_group_id(1);
+    const uint firstBin = range * RANGE_BINS;
+
+    for (uint b = lid; b < RANGE_BINS; b += lsize) {
+        subHist[b] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    const uint begin = rangeStart[range];
+    const uint end = rangeStart[range + 1];
+    for (uint i = begin + get_global_id(0); i < end; i += get_global_size(0)) {
+        atomic_inc(&subHist[buckets[i] - firstBin]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint b = lid; b < RANGE_BINS && firstBin + b < BINS; b += lsize) {
+        if (subHist[b] != 0) {
+            atomic_add(&hist[firstBin + b], subHist[b]);
+        }
+    }
+}
\ No newline at end of file
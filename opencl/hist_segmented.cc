@@ -0,0 +1,280 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for segmented histograms: one histogram per segment of the input, in one launch.
+*
+* ICPX:    icpx hist_segmented.cc -o hist_segmented.exe -O2 -std=c++20 -lOpenCL
+* Usage:   hist_segmented.exe -kernel=hist_segmented.cl -segments=20000 -size=67108864 (as a sample)
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 16'777'216;
+    unsigned int Bins = 256;
+    unsigned int Segments = 10'000;
+    std::string kernelPath = "hist_segmented.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-bins=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Bins);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -bins value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-segments=")) {
+            auto res = std::from_chars(arg.data() + 10, arg.data() + arg.size(), cfg.Segments);
+            if (res.ec != std::errc{} || cfg.Segments == 0) {
+                std::cerr << "Invalid -segments value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+constexpr unsigned int ITEMS = 16; // elements per work-item in every chunk
+
+// Segmented histogram API: hist[s * bins + b] counts values[offsets[s] .. offsets[s + 1]) equal to b.
+// offsets holds segments + 1 entries, offsets[0] = 0 and offsets[segments] = N.
+cl::Event histogram_segmented(const cl::CommandQueue& queue, cl::Kernel& kernel,
+    const cl::Buffer& values, const cl::Buffer& offsets, unsigned int segments,
+    const cl::Buffer& hist, unsigned int bins, unsigned int N, size_t groupSize) {
+    // Equal chunks per group: balanced whatever the segment lengths are
+    const unsigned int chunk = static_cast<unsigned int>(groupSize * ITEMS);
+    const size_t numGroups = std::max<size_t>(1, (N + chunk - 1) / chunk);
+
+    cl::Event fillEvent;
+    queue.enqueueFillBuffer(hist, 0u, 0, static_cast<size_t>(segments) * bins * sizeof(unsigned int),
+        nullptr, &fillEvent);
+
+    kernel.setArg(0, values);
+    kernel.setArg(1, offsets);
+    kernel.setArg(2, segments);
+    kernel.setArg(3, hist);
+    kernel.setArg(4, N);
+    kernel.setArg(5, chunk);
+
+    std::vector<cl::Event> waitList{ fillEvent };
+    cl::Event event;
+    queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(numGroups * groupSize),
+        cl::NDRange(groupSize), &waitList, &event);
+    return event;
+}
+
+// CPU histogram
+
+void rand_init(std::vector<unsigned int>& v, unsigned int maxVal) {
+    static std::mt19937_64 gen;
+    std::uniform_int_distribution<unsigned int> dist(0, maxVal - 1);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Uneven segment lengths (log-normal), scaled to N values in total
+void rand_offsets(std::vector<unsigned int>& offsets, unsigned int N) {
+    static std::mt19937_64 gen;
+    std::lognormal_distribution<double> dist(0.0, 1.5);
+    const size_t segments = offsets.size() - 1;
+    std::vector<double> weight(segments);
+    double total = 0.0;
+    for (auto& w : weight) total += (w = dist(gen));
+
+    double running = 0.0;
+    offsets[0] = 0;
+    for (size_t s = 0; s < segments; ++s) {
+        running += weight[s];
+        offsets[s + 1] = static_cast<unsigned int>(running / total * N);
+    }
+    offsets[segments] = N;
+}
+
+void histogram_segmented_ref(const unsigned int* data, const unsigned int* offsets, unsigned int* hist,
+    unsigned int segments, unsigned int bins) {
+    std::fill(hist, hist + static_cast<size_t>(segments) * bins, 0);
+    for (unsigned int s = 0; s < segments; ++s) {
+        unsigned int* segHist = hist + static_cast<size_t>(s) * bins;
+        for (unsigned int i = offsets[s]; i < offsets[s + 1]; ++i) {
+            unsigned int val = data[i];
+            if (val < bins) {
+                segHist[val]++;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+    const unsigned int Bins = cfg.Bins;
+    const unsigned int Segments = cfg.Segments;
+    const size_t histSize = static_cast<size_t>(Segments) * Bins;
+
+    std::cout << "Input size: " << N << "\n";
+    std::cout << "Segments: " << Segments << "\n";
+    std::cout << "Histogram bins: " << Bins << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
+    std::string defines = "#define BINS " + std::to_string(Bins) + "\n";
+    kernelSource = defines + kernelSource;
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    if (Bins * sizeof(unsigned int) > selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>()) {
+        std::cerr << "Bins do not fit in local memory.\n";
+        return EXIT_FAILURE;
+    }
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+
+    std::vector<unsigned int> hostData(N);
+    std::vector<unsigned int> hostOffsets(Segments + 1);
+    std::vector<unsigned int> hostHist_gpu(histSize, 0);
+    std::vector<unsigned int> hostHist_cpu(histSize, 0);
+
+    rand_init(hostData, Bins);
+    rand_offsets(hostOffsets, N);
+
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    histogram_segmented_ref(hostData.data(), hostOffsets.data(), hostHist_cpu.data(), Segments, Bins);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    long cpuTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuEnd - cpuStart).count();
+
+    cl::Buffer bufferData(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        N * sizeof(unsigned int), hostData.data());
+    cl::Buffer bufferOffsets(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        (Segments + 1) * sizeof(unsigned int), hostOffsets.data());
+    cl::Buffer bufferHist(context, CL_MEM_READ_WRITE, histSize * sizeof(unsigned int));
+
+    cl::CommandQueue queue(context, selectedDevice,
+        cl::QueueProperties::Profiling | cl::QueueProperties::OutOfOrder);
+
+    cl::Program program(context, kernelSource);
+    program.build({ selectedDevice });
+
+    cl::Kernel kernel(program, "histogram_segmented");
+
+    auto gpuWallStart = std::chrono::high_resolution_clock::now();
+    cl::Event event = histogram_segmented(queue, kernel, bufferData, bufferOffsets, Segments,
+        bufferHist, Bins, N, groupSize);
+    queue.finish();
+    auto gpuWallEnd = std::chrono::high_resolution_clock::now();
+    long gpuWallTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(gpuWallEnd - gpuWallStart).count();
+
+    cl::copy(queue, bufferHist, hostHist_gpu.begin(), hostHist_gpu.end());
+
+    cl_ulong start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    cl_ulong end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    long gpuKernelTimeMs = static_cast<long>((end - start) / 1'000'000);
+    double seconds = static_cast<double>(end - start) * 1e-9;
+
+    std::cout << "GPU wall time:    " << gpuWallTimeMs << " ms\n";
+    std::cout << "GPU kernel time:  " << gpuKernelTimeMs << " ms\n";
+    std::cout << "GPU throughput:   " << N / seconds / 1e6 << " Melem/s, "
+        << Segments / seconds / 1e3 << " Ksegments/s\n";
+    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+
+    // Simple correctness check
+    bool correct = (hostHist_cpu == hostHist_gpu);
+    std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+    std::cout << "\ndone. Segmented histogram computed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
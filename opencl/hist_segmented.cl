@@ -0,0 +1,80 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_segmented OpenCL kernel
+*
+* One histogram per segment: hist[s * BINS + b] counts the values of
+* values[offsets[s] .. offsets[s + 1]) equal to b. Every work-group takes an
+* equal chunk of the values, whatever the segment lengths, so long and short
+* segments are balanced across groups. A chunk may cover several segments and
+* a segment may be split across chunks.
+*/
+
+/* #define BINS 256 */   /*for ocloc offline compilation*/
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
+
+__kernel void histogram_segmented(__global const uint* values,
+                                  __global const uint* offsets,
+                                  uint segments,
+                                  __global uint* hist,
+                                  uint n,
+                                  uint chunk) {
+    __local uint subHist[BINS];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    const uint begin = get_group_id(0) * chunk;
+    const uint end = min(begin + chunk, n);
+
+    // last segment starting at or before begin (skips empty segments)
+    uint lo = 0;
+    uint hi = segments;
+    while (hi - lo > 1) {
+        uint mid = (lo + hi) / 2;
+        if (offsets[mid] <= begin) lo = mid;
+        else hi = mid;
+    }
+
+    // pos, seg and segEnd are the same for the whole group, so the barriers below are uniform
+    uint seg = lo;
+    for (uint pos = begin; pos < end; ++seg) {
+        const uint segEnd = min(offsets[seg + 1], end);
+        __global uint* segHist = hist + (size_t)seg * BINS;
+
+        if (segEnd - pos >= BINS) {
+            // long piece: privatize in local memory, flush the non-zero bins
+            for (uint b = lid; b < BINS; b += lsize) {
+                subHist[b] = 0;
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+
+            for (uint i = pos + lid; i < segEnd; i += lsize) {
+                uint value = values[i];
+                if (value < BINS) {
+                    atomic_inc(&subHist[value]);
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+
+            for (uint b = lid; b < BINS; b += lsize) {
+                if (subHist[b] != 0) {
+                    atomic_add(&segHist[b], subHist[b]);
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+        else {
+            // short piece: clearing and flushing BINS counters would cost more than the piece itself
+            for (uint i = pos + lid; i < segEnd; i += lsize) {
+                uint value = values[i];
+                if (value < BINS) {
+                    atomic_inc(&segHist[value]);
+                }
+            }
+        }
+        pos = segEnd;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,381 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for histograms of inputs larger than memory, streamed from a file or stdin.
+*
+* ICPX:    icpx hist_stream.cc -o hist_stream.exe -O2 -std=c++20 -lOpenCL
+* Usage:   hist_stream.exe -input=data.bin -kernel=hist_local.cl -dtype=u8 (as a sample)
+*          head -c 4G /dev/urandom | hist_stream.exe -input=- -dtype=u16 -bins=65536 -verify
+*
+* The input is raw binary: consecutive little-endian elements of -dtype.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <filesystem>
+#include <algorithm>
+#include <future>
+#include <cstdio>
+#include <cstring>
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+//  OpenCL
+// Folds the per-chunk 32-bit histogram into the 64-bit total and clears it for the next chunk
+const char* accumulateKernel = R"(
+__kernel void accumulate(__global uint* chunkHist,
+                         __global ulong* total,
+                         const unsigned int bins) {
+    unsigned int id = get_global_id(0);
+    if (id < bins) {
+        total[id] += chunkHist[id];
+        chunkHist[id] = 0;
+    }
+}
+)";
+//  OpenCL
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int Bins = 256;
+    unsigned int ChunkMB = 64;  // bytes per chunk, in MiB
+    unsigned int DataBytes = 1; // input element size: 1 (u8), 2 (u16) or 4 (u32)
+    std::string inputPath = "";
+    std::string kernelPath = "hist_local.cl";
+    bool verify = false;
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-bins=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Bins);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -bins value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-chunk=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.ChunkMB);
+            if (res.ec != std::errc{} || cfg.ChunkMB == 0) {
+                std::cerr << "Invalid -chunk value (MiB)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-dtype=")) {
+            std::string_view dtype = arg.substr(7);
+            if (dtype == "u8") cfg.DataBytes = 1;
+            else if (dtype == "u16") cfg.DataBytes = 2;
+            else if (dtype == "u32") cfg.DataBytes = 4;
+            else {
+                std::cerr << "Invalid -dtype value (u8|u16|u32)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-input=")) {
+            cfg.inputPath = std::string(arg.substr(7));
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else if (arg == "-verify") {
+            cfg.verify = true;
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    if (cfg.inputPath.empty()) {
+        std::cerr << "Missing -input=<file> (or -input=- for stdin)\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+// Reads up to `bytes` bytes; short only at end of input (pipes may return partial reads)
+size_t readChunk(std::FILE* in, char* dst, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        size_t got = std::fread(dst + total, 1, bytes - total, in);
+        if (got == 0) break;
+        total += got;
+    }
+    return total;
+}
+
+constexpr unsigned int VEC = 4;           // elements per vector load in hist_atomic.cl
+constexpr unsigned int MAX_COPIES = 8;    // sub-histogram replicas per work-group in hist_local.cl
+constexpr unsigned int GROUPS_PER_CU = 2; // persistent groups per compute unit for hist_local.cl
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int Bins = cfg.Bins;
+    const size_t elemBytes = cfg.DataBytes;
+    const size_t chunkBytes = static_cast<size_t>(cfg.ChunkMB) * 1024 * 1024 / elemBytes * elemBytes;
+    const size_t chunkElems = chunkBytes / elemBytes;
+
+    std::cout << "Input: " << (cfg.inputPath == "-" ? "stdin" : cfg.inputPath) << "\n";
+    std::cout << "Element size: " << elemBytes << " byte(s)\n";
+    std::cout << "Chunk size: " << cfg.ChunkMB << " MiB\n";
+    std::cout << "Histogram bins: " << Bins << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::FILE* in = nullptr;
+    if (cfg.inputPath == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        in = stdin;
+    }
+    else {
+        in = std::fopen(cfg.inputPath.c_str(), "rb");
+        if (!in) {
+            std::cerr << "Failed to open input file: " << cfg.inputPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    if (chunkBytes > selectedDevice.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() || chunkElems > 0xFFFFFFFFull) {
+        std::cerr << "Chunk too large for one device allocation, lower -chunk\n";
+        return EXIT_FAILURE;
+    }
+
+    const size_t localMem = selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+
+    const bool localKernel = std::filesystem::path(cfg.kernelPath).filename() == "hist_local.cl";
+    const size_t subHistBytes = (static_cast<size_t>(Bins) + 1) * sizeof(unsigned int);
+    const unsigned int copies = static_cast<unsigned int>(std::min<size_t>(MAX_COPIES, localMem / subHistBytes));
+    if (localKernel && copies == 0) {
+        std::cerr << "Bins do not fit in local memory (" << localMem << " bytes), use hist_atomic.cl\n";
+        return EXIT_FAILURE;
+    }
+
+    const char* dataType = (elemBytes == 1) ? "uchar" : (elemBytes == 2) ? "ushort" : "uint";
+    std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
+    std::string defines = "#define BINS " + std::to_string(Bins) + "\n";
+    defines += "#define DATA_T " + std::string(dataType) + "\n";
+    if (localKernel) {
+        defines += "#define COPIES " + std::to_string(copies) + "\n";
+    }
+    kernelSource = defines + kernelSource;
+
+    cl::Program program(context, kernelSource);
+    program.build({ selectedDevice });
+    cl::Program accumulateProgram(context, accumulateKernel);
+    accumulateProgram.build({ selectedDevice });
+
+    // Per-chunk 32-bit bins (a chunk holds < 2^32 elements) and the 64-bit running total
+    cl::Buffer bufferChunkHist(context, CL_MEM_READ_WRITE, Bins * sizeof(unsigned int));
+    cl::Buffer bufferTotal(context, CL_MEM_READ_WRITE, Bins * sizeof(cl_ulong));
+
+    // Double buffering: chunk i uploads into slot i % 2 while chunk i - 1 is counted from the other slot
+    cl::Buffer bufferData[2] = {
+        cl::Buffer(context, CL_MEM_READ_ONLY, chunkBytes),
+        cl::Buffer(context, CL_MEM_READ_ONLY, chunkBytes)
+    };
+    std::vector<char> hostChunk[2] = { std::vector<char>(chunkBytes), std::vector<char>(chunkBytes) };
+
+    cl::CommandQueue queue(context, selectedDevice,
+        cl::QueueProperties::Profiling | cl::QueueProperties::OutOfOrder);
+
+    queue.enqueueFillBuffer(bufferChunkHist, 0u, 0, Bins * sizeof(unsigned int));
+    queue.enqueueFillBuffer(bufferTotal, cl_ulong(0), 0, Bins * sizeof(cl_ulong));
+    queue.finish();
+
+    cl::Kernel kernel(program, "histogram");
+    cl::Kernel accumulate(accumulateProgram, "accumulate");
+    accumulate.setArg(0, bufferChunkHist);
+    accumulate.setArg(1, bufferTotal);
+    accumulate.setArg(2, Bins);
+    const size_t accumulateGlobal = (Bins + groupSize - 1) / groupSize * groupSize;
+
+    std::vector<unsigned long long> hostHist_cpu(cfg.verify ? Bins : 0, 0);
+    auto count_cpu = [&](const char* bytes, size_t elems) {
+        for (size_t i = 0; i < elems; ++i) {
+            unsigned int val = 0;
+            std::memcpy(&val, bytes + i * elemBytes, elemBytes); // little-endian
+            if (val < Bins) hostHist_cpu[val]++;
+        }
+    };
+
+    auto wallStart = std::chrono::high_resolution_clock::now();
+
+    std::vector<cl::Event> writeEvent(2), histEvent(2);
+    cl::Event accumulateEvent;
+    bool slotBusy[2] = { false, false };
+    unsigned long long totalBytes = 0;
+    cl_ulong kernelNs = 0;
+    size_t chunks = 0;
+
+    int slot = 0;
+    std::future<size_t> pending = std::async(std::launch::async, readChunk, in, hostChunk[0].data(), chunkBytes);
+    for (;;) {
+        const size_t bytes = pending.get();
+        const size_t elems = bytes / elemBytes;
+        if (bytes % elemBytes != 0) {
+            std::cerr << "Warning: ignoring " << bytes % elemBytes << " trailing byte(s)\n";
+        }
+        if (elems == 0) break;
+        const bool lastChunk = bytes < chunkBytes;
+
+        // Read ahead into the other slot once its previous upload has left the host buffer
+        const int next = slot ^ 1;
+        if (!lastChunk) {
+            if (slotBusy[next]) writeEvent[next].wait();
+            pending = std::async(std::launch::async, readChunk, in, hostChunk[next].data(), chunkBytes);
+        }
+
+        // Upload waits for the previous kernel that read this device buffer
+        std::vector<cl::Event> writeDeps;
+        if (slotBusy[slot]) {
+            histEvent[slot].wait();
+            kernelNs += histEvent[slot].getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                - histEvent[slot].getProfilingInfo<CL_PROFILING_COMMAND_START>();
+            writeDeps.push_back(histEvent[slot]);
+        }
+        queue.enqueueWriteBuffer(bufferData[slot], CL_FALSE, 0, elems * elemBytes, hostChunk[slot].data(),
+            &writeDeps, &writeEvent[slot]);
+
+        // Counting waits for its upload and for the previous fold, which clears the chunk bins
+        std::vector<cl::Event> histDeps{ writeEvent[slot] };
+        if (chunks > 0) histDeps.push_back(accumulateEvent);
+
+        const unsigned int n = static_cast<unsigned int>(elems);
+        kernel.setArg(0, bufferData[slot]);
+        kernel.setArg(1, bufferChunkHist);
+        kernel.setArg(2, n);
+        size_t numGroups = localKernel
+            ? std::min((elems + groupSize - 1) / groupSize, computeUnits * GROUPS_PER_CU)
+            : ((elems + VEC - 1) / VEC + groupSize - 1) / groupSize;
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(numGroups * groupSize),
+            cl::NDRange(groupSize), &histDeps, &histEvent[slot]);
+
+        std::vector<cl::Event> accumulateDeps{ histEvent[slot] };
+        queue.enqueueNDRangeKernel(accumulate, cl::NullRange, cl::NDRange(accumulateGlobal),
+            cl::NDRange(groupSize), &accumulateDeps, &accumulateEvent);
+        queue.flush();
+
+        if (cfg.verify) count_cpu(hostChunk[slot].data(), elems);
+
+        slotBusy[slot] = true;
+        totalBytes += elems * elemBytes;
+        ++chunks;
+        slot = next;
+        if (lastChunk) break;
+    }
+    queue.finish();
+    for (int s = 0; s < 2; ++s) {
+        if (slotBusy[s]) {
+            kernelNs += histEvent[s].getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                - histEvent[s].getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        }
+    }
+
+    // Device to Host: only the final bins
+    std::vector<cl_ulong> hostHist_gpu(Bins);
+    cl::copy(queue, bufferTotal, hostHist_gpu.begin(), hostHist_gpu.end());
+
+    auto wallEnd = std::chrono::high_resolution_clock::now();
+    double wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    long wallTimeMs = static_cast<long>(wallSeconds * 1000.0);
+
+    if (in != stdin) std::fclose(in);
+
+    std::cout << "Chunks:           " << chunks << "\n";
+    std::cout << "Input bytes:      " << totalBytes << "\n";
+    std::cout << "Wall time:        " << wallTimeMs << " ms\n";
+    std::cout << "GPU kernel time:  " << kernelNs / 1'000'000 << " ms\n";
+    std::cout << "Throughput:       " << totalBytes / wallSeconds / 1e9 << " GB/s\n";
+
+    if (cfg.verify) {
+        bool correct = std::equal(hostHist_cpu.begin(), hostHist_cpu.end(), hostHist_gpu.begin());
+        std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+    std::cout << "\ndone. Histogram computed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* hist_subgroup OpenCL kernel
+*
+* hist_atomic with updates combined inside a sub-group: lanes that hit the
+* same bin are counted with a sub-group reduction and a single lane issues
+* one atomic for all of them. Requires cl_khr_subgroups or cl_intel_subgroups.
+*/
+
+/* #define BINS 256 */   /*for ocloc offline compilation*/
+/* #define ROUNDS 4 */
+/* #define DATA_T uint */    /* uchar, ushort or uint */
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+
+#if defined(cl_khr_subgroups)
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#elif defined(cl_intel_subgroups)
+#pragma OPENCL EXTENSION cl_intel_subgroups : enable
+#endif
+
+__kernel void histogram(__global const DATA_T* input,
+                        __global uint* hist,
+                        uint n) {
+    // no early return: every lane has to take part in the sub-group functions
+    const uint gid = get_global_id(0);
+    const uint value = (gid < n) ? input[gid] : BINS;
+    int pending = value < BINS;
+
+    // each round retires the smallest pending bin of the sub-group;
+    // low-entropy inputs finish here, the rest falls back to plain atomics
+    for (uint round = 0; round < ROUNDS && sub_group_any(pending); ++round) {
+        const uint bin = sub_group_reduce_min(pending ? value : UINT_MAX);
+        const int match = pending && value == bin;
+        const uint count = sub_group_reduce_add(match ? 1u : 0u);
+        if (get_sub_group_local_id() == 0) {
+            atomic_add(&hist[bin], count);
+        }
+        pending = pending && !match;
+    }
+
+    if (pending) {
+        atomic_inc(&hist[value]);
+    }
+}
\ No newline at end of file
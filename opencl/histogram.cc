@@ -5,7 +5,12 @@
 * A simple OpenCL application for histogram calculations on GPU and natively on the CPU.
 *
 * ICPX:    icpx histogram.cc -o histogram.exe -O2 -std=c++20 -lOpenCL
+*          Add -xHost (or -march=native) to enable the AVX2/AVX-512 path of the multi-threaded CPU histogram.
 * Usage:   histogram.exe -kernel=hist_atomic.cl -size=419430400 (as a sample)
+*          histogram.exe -kernel=hist_local.cl -size=419430400
+*          histogram.exe -kernel=auto -bins=16777216 (picks the kernel from bins and device limits)
+*          histogram.exe -kernel=hist_subgroup.cl -dist=skewed
+*          histogram.exe -kernel=hist_local.cl -dtype=u8 (input element type: u8, u16 or u32)
 */
 
 #include <iostream>
@@ -18,9 +23,18 @@
 #include <fstream>
 #include <sstream>
 #include <system_error>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <limits>
 
 #include <cstdlib>
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 #define CL_HPP_TARGET_OPENCL_VERSION 200
 #define CL_HPP_MINIMUM_OPENCL_VERSION 120
 
@@ -33,7 +47,9 @@
 struct Config {
     unsigned int N = 1'048'576;
     unsigned int Bins = 256;
-    std::string kernelPath = "";
+    std::string kernelPath = "auto";
+    bool skewed = false;
+    unsigned int DataBytes = 4; // input element size: 1 (u8), 2 (u16) or 4 (u32)
 };
 
 Config parseArgs(int argc, char* argv[]) {
@@ -57,6 +73,24 @@ Config parseArgs(int argc, char* argv[]) {
         else if (arg.starts_with("-kernel=")) {
             cfg.kernelPath = std::string(arg.substr(8));
         }
+        else if (arg.starts_with("-dist=")) {
+            std::string_view dist = arg.substr(6);
+            if (dist != "uniform" && dist != "skewed") {
+                std::cerr << "Invalid -dist value (uniform|skewed)\n";
+                std::exit(EXIT_FAILURE);
+            }
+            cfg.skewed = (dist == "skewed");
+        }
+        else if (arg.starts_with("-dtype=")) {
+            std::string_view dtype = arg.substr(7);
+            if (dtype == "u8") cfg.DataBytes = 1;
+            else if (dtype == "u16") cfg.DataBytes = 2;
+            else if (dtype == "u32") cfg.DataBytes = 4;
+            else {
+                std::cerr << "Invalid -dtype value (u8|u16|u32)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
         else {
             std::cerr << "Unknown option: " << arg << "\n";
             std::exit(EXIT_FAILURE);
@@ -76,15 +110,152 @@ std::string readKernelFile(const std::string& path) {
     return ss.str();
 }
 
+// Launch scheme expected by the kernel file
+enum class HistKernel {
+    Atomic,    // one element per work-item, global atomics (hist_atomic.cl)
+    Local,     // per-group sub-histograms in local memory, grid-stride loop (hist_local.cl)
+    Partition, // bins split into local-memory-sized ranges (hist_partition.cl)
+    SubGroup   // hist_atomic with per-sub-group aggregated updates (hist_subgroup.cl)
+};
+
+HistKernel kernelKind(const std::string& path) {
+    const std::string name = std::filesystem::path(path).filename().string();
+    if (name == "hist_local.cl") return HistKernel::Local;
+    if (name == "hist_partition.cl") return HistKernel::Partition;
+    if (name == "hist_subgroup.cl") return HistKernel::SubGroup;
+    return HistKernel::Atomic;
+}
+
+// OpenCL C name of the input element type (DATA_T in the kernels)
+template <typename T> constexpr const char* clTypeName();
+template <> constexpr const char* clTypeName<unsigned char>() { return "uchar"; }
+template <> constexpr const char* clTypeName<unsigned short>() { return "ushort"; }
+template <> constexpr const char* clTypeName<unsigned int>() { return "uint"; }
+
+constexpr unsigned int VEC = 4;           // elements per vector load (uchar4/ushort4/uint4)
+constexpr unsigned int MAX_COPIES = 8;    // sub-histogram replicas per work-group in hist_local.cl
+constexpr unsigned int GROUPS_PER_CU = 2; // persistent groups per compute unit for grid-stride kernels
+constexpr unsigned int SCATTER_ITEMS = 8; // elements per work-item per chunk in range_scatter
+constexpr unsigned int SUBGROUP_ROUNDS = 4; // aggregated bins per sub-group before plain atomics in hist_subgroup.cl
+
+// -kernel=auto: privatized kernel while the bins fit in local memory, range partitioning above that
+std::string pickKernel(const std::string& path, unsigned int bins, size_t localMem) {
+    if (path != "auto") return path;
+    const size_t subHistBytes = (static_cast<size_t>(bins) + 1) * sizeof(unsigned int);
+    return (subHistBytes <= localMem) ? "hist_local.cl" : "hist_partition.cl";
+}
+
+// Largest power of two not above x (x > 0)
+size_t floorPow2(size_t x) {
+    size_t p = 1;
+    while (p * 2 <= x) p *= 2;
+    return p;
+}
+
+bool hasSubGroups(const cl::Device& device) {
+    const std::string ext = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    return ext.find("cl_khr_subgroups") != std::string::npos || ext.find("cl_intel_subgroups") != std::string::npos;
+}
+
+// Sub-group built-ins are declared for OpenCL C 2.0 and later
+std::string buildOptions(const cl::Device& device, HistKernel kind) {
+    if (kind != HistKernel::SubGroup) return "";
+    const std::string version = device.getInfo<CL_DEVICE_OPENCL_C_VERSION>(); // "OpenCL C x.y ..."
+    if (version.starts_with("OpenCL C 3")) return "-cl-std=CL3.0";
+    if (version.starts_with("OpenCL C 2")) return "-cl-std=CL2.0";
+    return "";
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// Large-bin histogram: count per range, scatter into range buckets, histogram every bucket in local memory.
+// Returns the summed kernel time in ns.
+cl_ulong histogram_partitioned(const cl::Context& context, const cl::CommandQueue& queue, const cl::Program& program,
+    const cl::Buffer& bufferData, const cl::Buffer& bufferHist, unsigned int N, size_t elemBytes,
+    unsigned int ranges, size_t groupSize, size_t persistentGroups) {
+    cl::Buffer bufferBuckets(context, CL_MEM_READ_WRITE, static_cast<size_t>(N) * elemBytes);
+    cl::Buffer bufferCursor(context, CL_MEM_READ_WRITE, (ranges + 1) * sizeof(unsigned int));
+    cl::Buffer bufferStart(context, CL_MEM_READ_ONLY, (ranges + 1) * sizeof(unsigned int));
+
+    queue.enqueueFillBuffer(bufferCursor, 0u, 0, (ranges + 1) * sizeof(unsigned int));
+    queue.finish();
+
+    cl::Kernel countKernel(program, "range_count");
+    countKernel.setArg(0, bufferData);
+    countKernel.setArg(1, bufferCursor);
+    countKernel.setArg(2, N);
+
+    const size_t chunk = groupSize * SCATTER_ITEMS;
+    const size_t countGroups = std::min((N + groupSize - 1) / groupSize, persistentGroups);
+    const size_t scatterGroups = std::min((N + chunk - 1) / chunk, persistentGroups);
+
+    cl::Event countEvent;
+    queue.enqueueNDRangeKernel(countKernel, cl::NullRange, cl::NDRange(countGroups * groupSize),
+        cl::NDRange(groupSize), nullptr, &countEvent);
+    queue.finish();
+
+    // Exclusive scan of the range sizes: RANGES values, cheap on the host
+    std::vector<unsigned int> rangeStart(ranges + 1);
+    cl::copy(queue, bufferCursor, rangeStart.begin(), rangeStart.end());
+    unsigned int running = 0;
+    for (unsigned int r = 0; r <= ranges; ++r) {
+        unsigned int count = rangeStart[r];
+        rangeStart[r] = running;
+        running += count;
+    }
+    cl::copy(queue, rangeStart.begin(), rangeStart.end(), bufferCursor);
+    cl::copy(queue, rangeStart.begin(), rangeStart.end(), bufferStart);
+
+    cl::Kernel scatterKernel(program, "range_scatter");
+    scatterKernel.setArg(0, bufferData);
+    scatterKernel.setArg(1, bufferBuckets);
+    scatterKernel.setArg(2, bufferCursor);
+    scatterKernel.setArg(3, N);
+
+    cl::Event scatterEvent;
+    queue.enqueueNDRangeKernel(scatterKernel, cl::NullRange, cl::NDRange(scatterGroups * groupSize),
+        cl::NDRange(groupSize), nullptr, &scatterEvent);
+    queue.finish();
+
+    cl::Kernel histKernel(program, "range_histogram");
+    histKernel.setArg(0, bufferBuckets);
+    histKernel.setArg(1, bufferStart);
+    histKernel.setArg(2, bufferHist);
+
+    // Spread small range counts over several groups so that the device stays busy
+    const size_t groupsPerRange = std::max<size_t>(1, persistentGroups / ranges);
+
+    cl::Event histEvent;
+    queue.enqueueNDRangeKernel(histKernel, cl::NullRange, cl::NDRange(groupsPerRange * groupSize, ranges),
+        cl::NDRange(groupSize, 1), nullptr, &histEvent);
+    queue.finish();
+
+    std::cout << "Bin ranges: " << ranges << " (" << groupsPerRange << " group(s) per range)\n";
+
+    return elapsedNs(countEvent) + elapsedNs(scatterEvent) + elapsedNs(histEvent);
+}
+
 // CPU histogram
 
-void rand_init(std::vector<unsigned int>& v, unsigned int maxVal) {
+template <typename T>
+void rand_init(std::vector<T>& v, unsigned int maxVal) {
     static std::mt19937_64 gen;
     std::uniform_int_distribution<unsigned int> dist(0, maxVal - 1);
-    for (auto& x : v) x = dist(gen);
+    for (auto& x : v) x = static_cast<T>(dist(gen));
 }
 
-void histogram_ref(const unsigned int* data, unsigned int* hist, unsigned int N, unsigned int bins) {
+// Low-entropy input: a few bins take most of the elements
+template <typename T>
+void rand_init_skewed(std::vector<T>& v, unsigned int maxVal) {
+    static std::mt19937_64 gen;
+    std::geometric_distribution<unsigned int> dist(0.2);
+    for (auto& x : v) x = static_cast<T>(dist(gen) % maxVal);
+}
+
+template <typename T>
+void histogram_ref(const T* data, unsigned int* hist, unsigned int N, unsigned int bins) {
     std::fill(hist, hist + bins, 0);
     for (unsigned int i = 0; i < N; ++i) {
         unsigned int val = data[i];
@@ -94,18 +265,126 @@ void histogram_ref(const unsigned int* data, unsigned int* hist, unsigned int N,
     }
 }
 
-int main(int argc, char* argv[]) try {
-    Config cfg = parseArgs(argc, argv);
+constexpr unsigned int CPU_COPIES = 4;                 // interleaved private histograms per thread
+constexpr size_t CPU_PRIVATE_LIMIT = size_t(1) << 26; // counters in all private histograms (256 MB)
+
+#if defined(__AVX512F__)
+// 16 elements widened to 32-bit lanes
+template <typename T>
+__m512i load16(const T* p) {
+    if constexpr (sizeof(T) == 1) return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    else if constexpr (sizeof(T) == 2) return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    else return _mm512_loadu_si512(p);
+}
+#elif defined(__AVX2__)
+// 8 elements widened to 32-bit lanes
+template <typename T>
+__m256i load8(const T* p) {
+    if constexpr (sizeof(T) == 1) return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    else if constexpr (sizeof(T) == 2) return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    else return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+#endif
+
+// Counts data[begin, end) into `copies` interleaved histograms of `bins` counters each: neighbouring
+// elements go to different copies, so repeated values do not wait on each other's stores.
+template <typename T>
+void histogram_cpu_chunk(const T* data, unsigned int* hist, size_t begin, size_t end,
+    unsigned int bins, unsigned int copies) {
+    size_t i = begin;
+#if defined(__AVX512F__)
+    const __m512i limit = _mm512_set1_epi32(static_cast<int>(bins));
+    alignas(64) unsigned int lane[16];
+    for (; i + 16 <= end; i += 16) {
+        const __m512i v = load16(data + i);
+        const unsigned int inRange = _mm512_cmplt_epu32_mask(v, limit);
+        _mm512_store_si512(lane, v);
+        for (unsigned int k = 0; k < 16; ++k) {
+            if (inRange & (1u << k)) hist[(k % copies) * bins + lane[k]]++;
+        }
+    }
+#elif defined(__AVX2__)
+    // AVX2 has no unsigned compare: v < bins <=> min(v, bins - 1) == v
+    const __m256i last = _mm256_set1_epi32(static_cast<int>(bins - 1));
+    alignas(32) unsigned int lane[8];
+    for (; i + 8 <= end; i += 8) {
+        const __m256i v = load8(data + i);
+        const __m256i fits = _mm256_cmpeq_epi32(_mm256_min_epu32(v, last), v);
+        const unsigned int inRange = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(fits)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lane), v);
+        for (unsigned int k = 0; k < 8; ++k) {
+            if (inRange & (1u << k)) hist[(k % copies) * bins + lane[k]]++;
+        }
+    }
+#endif
+    for (; i < end; ++i) {
+        unsigned int val = data[i];
+        if (val < bins) {
+            hist[(i % copies) * bins + val]++;
+        }
+    }
+}
+
+// Multi-threaded CPU histogram: private histograms per thread, then every thread merges a slice of bins.
+// Beyond CPU_PRIVATE_LIMIT counters the threads share the output and update it atomically.
+template <typename T>
+void histogram_cpu_parallel(const T* data, unsigned int* hist, unsigned int N, unsigned int bins,
+    unsigned int numThreads) {
+    std::fill(hist, hist + bins, 0);
+
+    const bool shared = static_cast<size_t>(bins) * numThreads > CPU_PRIVATE_LIMIT;
+    const unsigned int copies =
+        (static_cast<size_t>(bins) * numThreads * CPU_COPIES <= CPU_PRIVATE_LIMIT) ? CPU_COPIES : 1;
+    const size_t privateSize = shared ? 0 : static_cast<size_t>(bins) * copies;
+    std::vector<unsigned int> priv(privateSize * numThreads, 0);
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const size_t begin = static_cast<size_t>(N) * t / numThreads;
+            const size_t end = static_cast<size_t>(N) * (t + 1) / numThreads;
+            if (shared) {
+                for (size_t i = begin; i < end; ++i) {
+                    unsigned int val = data[i];
+                    if (val < bins) {
+                        std::atomic_ref<unsigned int>(hist[val]).fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+            else {
+                histogram_cpu_chunk(data, priv.data() + privateSize * t, begin, end, bins, copies);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    if (shared) return;
+
+    threads.clear();
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t] {
+            const size_t begin = static_cast<size_t>(bins) * t / numThreads;
+            const size_t end = static_cast<size_t>(bins) * (t + 1) / numThreads;
+            for (size_t p = 0; p < static_cast<size_t>(numThreads) * copies; ++p) {
+                const unsigned int* src = priv.data() + p * bins;
+                for (size_t b = begin; b < end; ++b) {
+                    hist[b] += src[b];
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+}
+
+template <typename T>
+int run_histogram(const Config& cfg) {
     const unsigned int N = cfg.N;
     const unsigned int Bins = cfg.Bins;
+    // Values above the element type range never occur
+    const unsigned int maxVal = static_cast<unsigned int>(
+        std::min<unsigned long long>(Bins, std::numeric_limits<T>::max() + 1ull));
 
-    std::cout << "Input size: " << N << "\n";
+    std::cout << "Input size: " << N << " x " << clTypeName<T>() << "\n";
     std::cout << "Histogram bins: " << Bins << "\n";
-    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
-
-    std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
-    std::string defines = "#define BINS " + std::to_string(Bins) + "\n";
-    kernelSource = defines + kernelSource;
 
     std::vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
@@ -143,57 +422,140 @@ int main(int argc, char* argv[]) try {
     std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
     std::cout << "Selected GPU: " << deviceName << "\n\n";
 
-    std::vector<unsigned int> hostData(N);
+    const size_t localMem = selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const size_t persistentGroups = computeUnits * GROUPS_PER_CU;
+
+    std::string kernelPath = pickKernel(cfg.kernelPath, Bins, localMem);
+    if (kernelKind(kernelPath) == HistKernel::SubGroup && !hasSubGroups(selectedDevice)) {
+        std::cout << "Device has no sub-group support, falling back to hist_atomic.cl\n";
+        kernelPath = std::filesystem::path(kernelPath).replace_filename("hist_atomic.cl").string();
+    }
+    const HistKernel kind = kernelKind(kernelPath);
+    std::cout << "Kernel file: " << kernelPath << "\n";
+
+    // Sub-histogram replicas: as many as fit in local memory, up to MAX_COPIES
+    const size_t subHistBytes = (static_cast<size_t>(Bins) + 1) * sizeof(unsigned int);
+    const unsigned int copies = static_cast<unsigned int>(std::min<size_t>(MAX_COPIES, localMem / subHistBytes));
+    if (kind == HistKernel::Local && copies == 0) {
+        std::cerr << "Bins do not fit in local memory (" << localMem << " bytes), use hist_atomic.cl\n";
+        return EXIT_FAILURE;
+    }
+
+    // Range size: half of local memory, so that two groups can share a compute unit
+    const size_t rangeBins = std::min<size_t>(floorPow2(localMem / (2 * sizeof(unsigned int))), floorPow2(Bins));
+    const unsigned int ranges = static_cast<unsigned int>((Bins + rangeBins - 1) / rangeBins);
+    if (kind == HistKernel::Partition && 2 * ranges * sizeof(unsigned int) > localMem) {
+        std::cerr << "Too many bin ranges for local memory (" << ranges << ")\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string kernelSource = readKernelFile(kernelPath); /* Read kernel */
+    std::string defines = "#define BINS " + std::to_string(Bins) + "\n";
+    defines += "#define DATA_T " + std::string(clTypeName<T>()) + "\n";
+    if (kind == HistKernel::Local) {
+        defines += "#define COPIES " + std::to_string(copies) + "\n";
+        std::cout << "Local sub-histograms per group: " << copies << "\n";
+    }
+    if (kind == HistKernel::SubGroup) {
+        defines += "#define ROUNDS " + std::to_string(SUBGROUP_ROUNDS) + "\n";
+    }
+    if (kind == HistKernel::Partition) {
+        defines += "#define RANGE_BINS " + std::to_string(rangeBins) + "u\n";
+        defines += "#define RANGES " + std::to_string(ranges) + "\n";
+        defines += "#define ITEMS " + std::to_string(SCATTER_ITEMS) + "\n";
+        std::cout << "Bins per range: " << rangeBins << "\n";
+    }
+    kernelSource = defines + kernelSource;
+    std::cout << "\n";
+
+    std::vector<T> hostData(N);
     std::vector<unsigned int> hostHist_gpu(Bins, 0);
     std::vector<unsigned int> hostHist_cpu(Bins, 0);
+    std::vector<unsigned int> hostHist_cpuMT(Bins, 0);
 
-    rand_init(hostData, Bins);
+    if (cfg.skewed) {
+        rand_init_skewed(hostData, maxVal);
+    }
+    else {
+        rand_init(hostData, maxVal);
+    }
 
     auto cpuStart = std::chrono::high_resolution_clock::now();
     histogram_ref(hostData.data(), hostHist_cpu.data(), N, Bins);
     auto cpuEnd = std::chrono::high_resolution_clock::now();
     long cpuTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuEnd - cpuStart).count();
 
+    const unsigned int cpuThreads = std::max(1u, std::thread::hardware_concurrency());
+    auto cpuMTStart = std::chrono::high_resolution_clock::now();
+    histogram_cpu_parallel(hostData.data(), hostHist_cpuMT.data(), N, Bins, cpuThreads);
+    auto cpuMTEnd = std::chrono::high_resolution_clock::now();
+    long cpuMTTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuMTEnd - cpuMTStart).count();
+
     cl::Buffer bufferData(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        N * sizeof(unsigned int), hostData.data());
-    cl::Buffer bufferHist(context, CL_MEM_WRITE_ONLY, Bins * sizeof(unsigned int));
+        N * sizeof(T), hostData.data());
+    cl::Buffer bufferHist(context, CL_MEM_READ_WRITE, Bins * sizeof(unsigned int));
 
     cl::CommandQueue queue(context, selectedDevice,
         cl::QueueProperties::Profiling | cl::QueueProperties::OutOfOrder);
 
+    // Kernels accumulate with atomics, so the bins start from zero
+    queue.enqueueFillBuffer(bufferHist, 0u, 0, Bins * sizeof(unsigned int));
+    queue.finish();
+
     cl::Program program(context, kernelSource);
-    program.build({ selectedDevice });
+    program.build({ selectedDevice }, buildOptions(selectedDevice, kind).c_str());
 
-    cl::Kernel kernel(program, "histogram");
-    kernel.setArg(0, bufferData);
-    kernel.setArg(1, bufferHist);
-    kernel.setArg(2, N);
+    cl_ulong gpuKernelNs = 0;
+    auto gpuWallStart = std::chrono::high_resolution_clock::now();
 
-    // 1D grid
-    cl::NDRange globalSize(N);
-    cl::NDRange localSize(256);
+    if (kind == HistKernel::Partition) {
+        gpuKernelNs = histogram_partitioned(context, queue, program, bufferData, bufferHist, N, sizeof(T),
+            ranges, groupSize, persistentGroups);
+    }
+    else {
+        cl::Kernel kernel(program, "histogram");
+        kernel.setArg(0, bufferData);
+        kernel.setArg(1, bufferHist);
+        kernel.setArg(2, N);
+
+        // 1D grid: hist_atomic.cl reads one vector per work-item
+        const size_t items = (kind == HistKernel::Atomic) ? (N + VEC - 1) / VEC : N;
+        size_t numGroups = (items + groupSize - 1) / groupSize;
+        if (kind == HistKernel::Local) {
+            // Persistent groups: enough to fill the device, each one loops over many elements
+            const size_t groupsPerCU = std::clamp<size_t>(localMem / (copies * subHistBytes), 1, 4);
+            numGroups = std::min(numGroups, computeUnits * groupsPerCU);
+        }
+        cl::NDRange globalSize(numGroups * groupSize);
+        cl::NDRange localSize(groupSize);
+
+        cl::Event event;
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize, nullptr, &event);
+        queue.finish();
+        gpuKernelNs = elapsedNs(event);
+    }
 
-    auto gpuWallStart = std::chrono::high_resolution_clock::now();
-    cl::Event event;
-    queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize, nullptr, &event);
-    queue.finish();
     auto gpuWallEnd = std::chrono::high_resolution_clock::now();
     long gpuWallTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(gpuWallEnd - gpuWallStart).count();
 
     cl::copy(queue, bufferHist, hostHist_gpu.begin(), hostHist_gpu.end());
 
-    cl_ulong start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
-    cl_ulong end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
-    long gpuKernelTimeMs = static_cast<long>((end - start) / 1'000'000);
+    long gpuKernelTimeMs = static_cast<long>(gpuKernelNs / 1'000'000);
+    double gpuElemsPerSec = N / (static_cast<double>(gpuKernelNs) * 1e-9);
+    double gpuGBPerSec = gpuElemsPerSec * sizeof(T) / 1e9;
 
     std::cout << "GPU wall time:    " << gpuWallTimeMs << " ms\n";
     std::cout << "GPU kernel time:  " << gpuKernelTimeMs << " ms\n";
+    std::cout << "GPU throughput:   " << gpuElemsPerSec / 1e6 << " Melem/s, " << gpuGBPerSec << " GB/s\n";
     std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "CPU MT time:      " << cpuMTTimeMs << " ms (" << cpuThreads << " threads)\n";
 
     // Simple correctness check
     bool correct = true;
     for (unsigned int i = 0; i < Bins; ++i) {
-        if (hostHist_cpu[i] != hostHist_gpu[i]) {
+        if (hostHist_cpu[i] != hostHist_gpu[i] || hostHist_cpu[i] != hostHist_cpuMT[i]) {
             correct = false;
             break;
         }
@@ -203,6 +565,18 @@ int main(int argc, char* argv[]) try {
 
     return EXIT_SUCCESS;
 }
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    switch (cfg.DataBytes) {
+    case 1:
+        return run_histogram<unsigned char>(cfg);
+    case 2:
+        return run_histogram<unsigned short>(cfg);
+    default:
+        return run_histogram<unsigned int>(cfg);
+    }
+}
 catch (const cl::Error& e) {
     std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
     return EXIT_FAILURE;
@@ -0,0 +1,100 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* matrix_epilogue OpenCL kernels
+*
+* Tiled GEMM C = A * B (N x N, row-major) with an elementwise epilogue applied to the accumulator
+* before the store, chosen at build time:
+*   ALPHA x             - scales the product
+*   BIAS_ROW / BIAS_COL - adds bias[row] or bias[col]
+*   RELU / GELU / SIGMOID - activation
+*   RESIDUAL            - adds R[row][col] after the activation
+* so C = act(ALPHA * A * B + bias) + R. With none of them defined it is the plain tiled product.
+*   matrixmult_epilogue - the product with the epilogue fused into the store
+*   epilogue            - the same epilogue as a separate pass over C, for comparison
+* bias and R are not read unless their define is set; the host may pass any buffer for them.
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+/* #define ALPHA 1.0f */
+/* #define BIAS_COL */
+/* #define GELU */
+/* #define RESIDUAL */
+
+inline float apply_epilogue(float v, uint row, uint col, uint N,
+                            __global const float* bias, __global const float* R) {
+#ifdef ALPHA
+    v *= ALPHA;
+#endif
+#if defined(BIAS_ROW)
+    v += bias[row];
+#elif defined(BIAS_COL)
+    v += bias[col];
+#endif
+#if defined(RELU)
+    v = fmax(v, 0.0f);
+#elif defined(GELU)
+    v = 0.5f * v * (1.0f + erf(v * M_SQRT1_2_F));
+#elif defined(SIGMOID)
+    v = 1.0f / (1.0f + exp(-v));
+#endif
+#ifdef RESIDUAL
+    v += R[(size_t)row * N + col];
+#endif
+    return v;
+}
+
+__kernel void matrixmult_epilogue(__global const float* A,
+                                  __global const float* B,
+                                  __global float* C,
+                                  __global const float* bias,
+                                  __global const float* R,
+                                  const unsigned int N)
+{
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    const int row = get_group_id(1) * TILE + ty;
+    const int col = get_group_id(0) * TILE + tx;
+
+    __local float Asub[TILE][TILE];
+    __local float Bsub[TILE][TILE];
+
+    float sum = 0.0f;
+
+    const int numTiles = (N + TILE - 1) / TILE; // ceil(N / TILE)
+    for (int t = 0; t < numTiles; ++t) {
+        const int k = t * TILE;
+
+        Asub[ty][tx] = (row < N && (k + tx) < N) ? A[row * N + (k + tx)] : 0.0f;
+        Bsub[ty][tx] = ((k + ty) < N && col < N) ? B[(k + ty) * N + col] : 0.0f;
+
+        // SYNC
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k_local = 0; k_local < TILE; ++k_local) {
+            sum += Asub[ty][k_local] * Bsub[k_local][tx];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < N && col < N) {
+        C[row * N + col] = apply_epilogue(sum, row, col, N, bias, R);
+    }
+}
+
+__kernel void epilogue(__global float* C,
+                       __global const float* bias,
+                       __global const float* R,
+                       const unsigned int N)
+{
+    const uint col = get_global_id(0);
+    const uint row = get_global_id(1);
+
+    if (row < N && col < N) {
+        const size_t i = (size_t)row * N + col;
+        C[i] = apply_epilogue(C[i], row, col, N, bias, R);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,395 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for matrix multiplication in tile-major storage: every TILE x TILE block is
+* contiguous, optionally with the tiles in Morton order, so each tile load reads one block instead
+* of TILE rows. The operands are converted once on the device, stay tile-major over repeated
+* multiplies, and the result is converted back. Compared with the row-major kernel from
+* matrix_localmem.cl, with the number of multiplies after which the conversion has paid for itself.
+*
+* ICPX:    icpx matrix_tiled.cc -o matrix_tiled.exe -O2 -std=c++20 -lOpenCL
+* Usage:   matrix_tiled.exe -size=1024 -tile=16 -reps=10 (as a sample)
+*          matrix_tiled.exe -size=2000 -morton
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 1024;
+    unsigned int Tile = 16;
+    unsigned int reps = 10;     // multiplies on the converted operands
+    bool morton = false;
+    std::string kernelPath = "matrix_tiled.cl";
+    std::string densePath = "matrix_localmem.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-tile=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Tile);
+            if (res.ec != std::errc{} || cfg.Tile == 0) {
+                std::cerr << "Invalid -tile value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-reps=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.reps);
+            if (res.ec != std::errc{} || cfg.reps == 0) {
+                std::cerr << "Invalid -reps value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-morton") {
+            cfg.morton = true;
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// TILE-MAJOR LAYOUT (same mapping as matrix_tiled.cl)
+
+struct TiledLayout {
+    unsigned int N = 0;
+    unsigned int tile = 0;
+    unsigned int tiles = 0;     // tiles per side of the padded matrix
+    unsigned int grid = 0;      // tiles per side of the storage: tiles, or the next power of two for Morton
+    bool morton = false;
+
+    TiledLayout(unsigned int N, unsigned int tile, bool morton) : N(N), tile(tile), morton(morton) {
+        tiles = (N + tile - 1) / tile;
+        grid = tiles;
+        if (morton) {
+            grid = 1;
+            while (grid < tiles) grid *= 2;
+        }
+    }
+
+    size_t elements() const { return static_cast<size_t>(grid) * grid * tile * tile; }
+
+    static unsigned int spread_bits(unsigned int x) {
+        x &= 0x0000ffff;
+        x = (x | (x << 8)) & 0x00ff00ff;
+        x = (x | (x << 4)) & 0x0f0f0f0f;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    size_t tile_offset(unsigned int bi, unsigned int bj) const {
+        const size_t index = morton ? (spread_bits(bi) << 1) | spread_bits(bj) : static_cast<size_t>(bi) * grid + bj;
+        return index * tile * tile;
+    }
+};
+
+// out must hold layout.elements(); the padding and unused Morton slots are zero
+void to_tiled(const float* in, float* out, const TiledLayout& layout) {
+    const unsigned int tile = layout.tile;
+    std::fill(out, out + layout.elements(), 0.0f);
+    for (unsigned int bi = 0; bi < layout.tiles; ++bi) {
+        for (unsigned int bj = 0; bj < layout.tiles; ++bj) {
+            float* block = out + layout.tile_offset(bi, bj);
+            for (unsigned int r = 0; r < tile && bi * tile + r < layout.N; ++r) {
+                const size_t row = static_cast<size_t>(bi * tile + r) * layout.N;
+                for (unsigned int c = 0; c < tile && bj * tile + c < layout.N; ++c) {
+                    block[r * tile + c] = in[row + bj * tile + c];
+                }
+            }
+        }
+    }
+}
+
+void from_tiled(const float* in, float* out, const TiledLayout& layout) {
+    const unsigned int tile = layout.tile;
+    for (unsigned int bi = 0; bi < layout.tiles; ++bi) {
+        for (unsigned int bj = 0; bj < layout.tiles; ++bj) {
+            const float* block = in + layout.tile_offset(bi, bj);
+            for (unsigned int r = 0; r < tile && bi * tile + r < layout.N; ++r) {
+                const size_t row = static_cast<size_t>(bi * tile + r) * layout.N;
+                for (unsigned int c = 0; c < tile && bj * tile + c < layout.N; ++c) {
+                    out[row + bj * tile + c] = block[r * tile + c];
+                }
+            }
+        }
+    }
+}
+
+// CPU matrix
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+// i-k-j order keeps the inner loop contiguous
+void matrix_mult_ref(const float* A, const float* B, float* C, unsigned int N) {
+    std::fill(C, C + static_cast<size_t>(N) * N, 0.0f);
+    for (unsigned int i = 0; i < N; ++i) {
+        for (unsigned int k = 0; k < N; ++k) {
+            const float a = A[static_cast<size_t>(i) * N + k];
+            for (unsigned int j = 0; j < N; ++j) {
+                C[static_cast<size_t>(i) * N + j] += a * B[static_cast<size_t>(k) * N + j];
+            }
+        }
+    }
+}
+
+bool nearlyEqual(const std::vector<float>& gpu, const std::vector<float>& cpu) {
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        if (std::abs(gpu[i] - cpu[i]) > 1e-3f * std::abs(cpu[i]) + 1e-3f) return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+    const unsigned int tile = cfg.Tile;
+    const size_t elements = static_cast<size_t>(N) * N;
+    const TiledLayout layout(N, tile, cfg.morton);
+    const size_t tiledElements = layout.elements();
+
+    std::cout << "Matrix size: " << N << " x " << N << ", tile size: " << tile << ", " << cfg.reps << " multiplies\n";
+    std::cout << "Tile order: " << (cfg.morton ? "Morton" : "row-major") << ", storage: " << layout.grid << " x " << layout.grid
+        << " tiles (" << std::setprecision(3) << 100.0 * tiledElements / elements << std::setprecision(6) << "% of row-major)\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << " vs " << cfg.densePath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    std::string defines = "#define TILE " + std::to_string(tile) + "\n";
+    cl::Program denseProgram(context, defines + readKernelFile(cfg.densePath));
+    denseProgram.build({ selectedDevice });
+    if (cfg.morton) defines += "#define MORTON\n";
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice });
+
+    std::vector<float> hostA(elements);
+    std::vector<float> hostB(elements);
+    std::vector<float> hostC_gpu(elements);
+    std::vector<float> hostC_cpu(elements);
+    rand_init(hostA, -1.0f, 1.0f);
+    rand_init(hostB, -1.0f, 1.0f);
+
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    matrix_mult_ref(hostA.data(), hostB.data(), hostC_cpu.data(), N);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    // Host converters: A and B in, C out, as a host-side conversion would cost
+    std::vector<float> hostAt(tiledElements);
+    std::vector<float> hostBt(tiledElements);
+    std::vector<float> roundTrip(elements);
+    auto convStart = std::chrono::high_resolution_clock::now();
+    to_tiled(hostA.data(), hostAt.data(), layout);
+    to_tiled(hostB.data(), hostBt.data(), layout);
+    from_tiled(hostAt.data(), roundTrip.data(), layout);
+    auto convEnd = std::chrono::high_resolution_clock::now();
+    double hostConvMs = std::chrono::duration<double, std::milli>(convEnd - convStart).count();
+    const bool hostRoundTrip = (roundTrip == hostA);
+
+    cl::Buffer bufferA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostA.data());
+    cl::Buffer bufferB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostB.data());
+    cl::Buffer bufferC(context, CL_MEM_READ_WRITE, elements * sizeof(float));
+    cl::Buffer bufferAt(context, CL_MEM_READ_WRITE, tiledElements * sizeof(float));
+    cl::Buffer bufferBt(context, CL_MEM_READ_WRITE, tiledElements * sizeof(float));
+    cl::Buffer bufferCt(context, CL_MEM_READ_WRITE, tiledElements * sizeof(float));
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    const cl::NDRange localSize(tile, tile);
+    const cl::NDRange global(static_cast<size_t>(layout.tiles) * tile, static_cast<size_t>(layout.tiles) * tile);
+
+    // Row-major baseline
+    cl::Kernel denseKernel(denseProgram, "matrixmult");
+    denseKernel.setArg(0, bufferA);
+    denseKernel.setArg(1, bufferB);
+    denseKernel.setArg(2, bufferC);
+    denseKernel.setArg(3, N);
+
+    cl_ulong denseNs = 0;
+    for (unsigned int r = 0; r < cfg.reps; ++r) {
+        cl::Event event;
+        queue.enqueueNDRangeKernel(denseKernel, cl::NullRange, global, localSize, nullptr, &event);
+        event.wait();
+        denseNs += elapsedNs(event);
+    }
+    queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, elements * sizeof(float), hostC_gpu.data());
+    const bool denseCorrect = nearlyEqual(hostC_gpu, hostC_cpu);
+
+    // Tile-major: convert A and B once, multiply reps times, convert C back
+    cl::Kernel toTiled(program, "to_tiled");
+    cl::Kernel fromTiled(program, "from_tiled");
+    cl::Kernel tiledKernel(program, "matrixmult_tiled");
+
+    // unused Morton slots are never written: clear them once
+    queue.enqueueFillBuffer(bufferAt, 0.0f, 0, tiledElements * sizeof(float));
+    queue.enqueueFillBuffer(bufferBt, 0.0f, 0, tiledElements * sizeof(float));
+
+    cl::Event toAEvent, toBEvent, fromEvent;
+    toTiled.setArg(0, bufferA);
+    toTiled.setArg(1, bufferAt);
+    toTiled.setArg(2, N);
+    toTiled.setArg(3, layout.grid);
+    queue.enqueueNDRangeKernel(toTiled, cl::NullRange, global, localSize, nullptr, &toAEvent);
+    toTiled.setArg(0, bufferB);
+    toTiled.setArg(1, bufferBt);
+    queue.enqueueNDRangeKernel(toTiled, cl::NullRange, global, localSize, nullptr, &toBEvent);
+
+    tiledKernel.setArg(0, bufferAt);
+    tiledKernel.setArg(1, bufferBt);
+    tiledKernel.setArg(2, bufferCt);
+    tiledKernel.setArg(3, layout.tiles);
+    tiledKernel.setArg(4, layout.grid);
+
+    cl_ulong tiledNs = 0;
+    for (unsigned int r = 0; r < cfg.reps; ++r) {
+        cl::Event event;
+        queue.enqueueNDRangeKernel(tiledKernel, cl::NullRange, global, localSize, nullptr, &event);
+        event.wait();
+        tiledNs += elapsedNs(event);
+    }
+
+    fromTiled.setArg(0, bufferCt);
+    fromTiled.setArg(1, bufferC);
+    fromTiled.setArg(2, N);
+    fromTiled.setArg(3, layout.grid);
+    queue.enqueueNDRangeKernel(fromTiled, cl::NullRange, global, localSize, nullptr, &fromEvent);
+    queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, elements * sizeof(float), hostC_gpu.data());
+    const bool tiledCorrect = nearlyEqual(hostC_gpu, hostC_cpu);
+
+    // the device converter must produce exactly the host layout
+    std::vector<float> deviceAt(tiledElements);
+    queue.enqueueReadBuffer(bufferAt, CL_TRUE, 0, tiledElements * sizeof(float), deviceAt.data());
+    const bool convertersAgree = hostRoundTrip && (deviceAt == hostAt);
+
+    const double denseMs = denseNs * 1e-6 / cfg.reps;
+    const double tiledMs = tiledNs * 1e-6 / cfg.reps;
+    const double convertMs = (elapsedNs(toAEvent) + elapsedNs(toBEvent) + elapsedNs(fromEvent)) * 1e-6;
+    const double flops = 2.0 * N * N * static_cast<double>(N);
+
+    std::cout << std::left << std::setw(14) << "layout" << std::setw(16) << "ms / multiply" << std::setw(12) << "GFLOPS" << "check\n";
+    std::cout << std::left << std::setw(14) << "row-major" << std::setw(16) << denseMs << std::setw(12) << flops / (denseMs * 1e6)
+        << (denseCorrect ? "PASSED" : "FAILED") << "\n";
+    std::cout << std::left << std::setw(14) << "tile-major" << std::setw(16) << tiledMs << std::setw(12) << flops / (tiledMs * 1e6)
+        << (tiledCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\nConversion (device): " << convertMs << " ms (A and B in, C out)\n";
+    std::cout << "Conversion (host):   " << hostConvMs << " ms (A and B in, one matrix out)\n";
+    std::cout << "Converters agree:    " << (convertersAgree ? "yes" : "NO") << "\n";
+    if (tiledMs < denseMs) {
+        const double breakEven = convertMs / (denseMs - tiledMs);
+        std::cout << "Amortization point:  " << static_cast<unsigned long long>(std::ceil(breakEven))
+            << " multiplies per conversion (" << breakEven << ")\n";
+    }
+    else {
+        std::cout << "Amortization point:  never, the tile-major multiply is not faster here\n";
+    }
+
+    std::cout << "\nCPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "\nResult correctness: " << (denseCorrect && tiledCorrect && convertersAgree ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Tile-major matrix multiplication completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
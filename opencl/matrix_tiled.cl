@@ -0,0 +1,97 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* matrix_tiled OpenCL kernels
+*
+* Tile-major storage: the N x N matrix is padded with zeros to whole TILE x TILE tiles and every tile
+* is stored as one contiguous row-major block of TILE * TILE floats. Tiles follow one another in
+* row-major tile order, or in Morton (Z) order with MORTON defined, where the tile grid is padded to
+* a power of two and grid is its side:
+*   to_tiled         - row-major -> tile-major, zeros in the padding
+*   from_tiled       - tile-major -> row-major
+*   matrixmult_tiled - C = A * B with all three tile-major: every tile load is one contiguous block
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+/* #define MORTON */
+
+// spreads the low 16 bits of x to the even bit positions
+inline uint spread_bits(uint x) {
+    x &= 0x0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+inline size_t tile_offset(uint bi, uint bj, uint grid) {
+#ifdef MORTON
+    const size_t index = (spread_bits(bi) << 1) | spread_bits(bj);
+#else
+    const size_t index = (size_t)bi * grid + bj;
+#endif
+    return index * (TILE * TILE);
+}
+
+// One work-item per element of the padded matrix, one group per tile
+__kernel void to_tiled(__global const float* in,
+                       __global float* out,
+                       const unsigned int N,
+                       const unsigned int grid)
+{
+    const uint col = get_global_id(0);
+    const uint row = get_global_id(1);
+
+    const float v = (row < N && col < N) ? in[(size_t)row * N + col] : 0.0f;
+    out[tile_offset(get_group_id(1), get_group_id(0), grid) + get_local_id(1) * TILE + get_local_id(0)] = v;
+}
+
+__kernel void from_tiled(__global const float* in,
+                         __global float* out,
+                         const unsigned int N,
+                         const unsigned int grid)
+{
+    const uint col = get_global_id(0);
+    const uint row = get_global_id(1);
+
+    if (row < N && col < N) {
+        out[(size_t)row * N + col] = in[tile_offset(get_group_id(1), get_group_id(0), grid) + get_local_id(1) * TILE + get_local_id(0)];
+    }
+}
+
+// tiles: tiles per side of the padded matrix; no bounds checks, the padding holds zeros
+__kernel void matrixmult_tiled(__global const float* A,
+                               __global const float* B,
+                               __global float* C,
+                               const unsigned int tiles,
+                               const unsigned int grid)
+{
+    __local float Asub[TILE][TILE];
+    __local float Bsub[TILE][TILE];
+
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+    const uint bi = get_group_id(1);
+    const uint bj = get_group_id(0);
+    const int inTile = ty * TILE + tx;
+
+    float sum = 0.0f;
+
+    for (uint t = 0; t < tiles; ++t) {
+        Asub[ty][tx] = A[tile_offset(bi, t, grid) + inTile];
+        Bsub[ty][tx] = B[tile_offset(t, bj, grid) + inTile];
+
+        // SYNC
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k_local = 0; k_local < TILE; ++k_local) {
+            sum += Asub[ty][k_local] * Bsub[k_local][tx];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    C[tile_offset(bi, bj, grid) + inTile] = sum;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* matrix_transposed OpenCL kernel
+*
+* C = A * B with B given transposed (Bt = B^T, both N x N row-major).
+* Both operands are read along rows, so every tile load is coalesced; dimension 0 runs along columns of C.
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+
+__kernel void matrixmult_bt(__global const float* A,
+                            __global const float* Bt,
+                            __global float* C,
+                            const unsigned int N)
+{
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    const int row = get_group_id(1) * TILE + ty;
+    const int col = get_group_id(0) * TILE + tx;
+    const int colBase = get_group_id(0) * TILE;
+
+    __local float Asub[TILE][TILE];
+    __local float Bsub[TILE][TILE + 1]; // Bsub[c][k] is read down a column: padding avoids bank conflicts
+
+    float sum = 0.0f;
+
+    const int numTiles = (N + TILE - 1) / TILE; // ceil(N / TILE)
+    for (int t = 0; t < numTiles; ++t) {
+        const int k = t * TILE;
+
+        if (row < N && (k + tx) < N) {
+            Asub[ty][tx] = A[row * N + (k + tx)];
+        } else {
+            Asub[ty][tx] = 0.0f;
+        }
+
+        // row colBase + ty of Bt is column colBase + ty of B
+        if ((colBase + ty) < N && (k + tx) < N) {
+            Bsub[ty][tx] = Bt[(colBase + ty) * N + (k + tx)];
+        } else {
+            Bsub[ty][tx] = 0.0f;
+        }
+
+        // SYNC
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k_local = 0; k_local < TILE; ++k_local) {
+            sum += Asub[ty][k_local] * Bsub[tx][k_local];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < N && col < N) {
+        C[row * N + col] = sum;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,362 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for LSD radix sort of 32-bit keys (uint or float), optionally with uint payloads.
+* Every pass: per-tile digit histograms, a global scan of the counts (scan.cl), a stable scatter.
+*
+* ICPX:    icpx radix_sort.cc -o radix_sort.exe -O2 -std=c++20 -lOpenCL -ltbb
+*          (-ltbb backs std::execution::par in libstdc++)
+* Usage:   radix_sort.exe -size=16777216 -bits=8 (as a sample)
+*          radix_sort.exe -type=float -pairs -bits=4
+*
+* radix_sort.cl and scan.cl are read from the same directory.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <execution>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 16'777'216;
+    unsigned int Bits = 8;   // radix bits per pass, 4..8
+    bool floatKeys = false;
+    bool pairs = false;      // sort (key, uint payload) pairs
+    std::string kernelPath = "radix_sort.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-bits=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Bits);
+            if (res.ec != std::errc{} || cfg.Bits < 4 || cfg.Bits > 8) {
+                std::cerr << "Invalid -bits value (4..8)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-type=")) {
+            std::string_view type = arg.substr(6);
+            if (type == "uint") cfg.floatKeys = false;
+            else if (type == "float") cfg.floatKeys = true;
+            else {
+                std::cerr << "Invalid -type value (uint|float)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-pairs") {
+            cfg.pairs = true;
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+constexpr unsigned int ITEMS = 8; // keys per work-item in every tile
+
+// Sorts N keys (and payloads) in place, ping-ponging through the scratch buffers.
+// Returns the summed kernel time in ns.
+cl_ulong radix_sort(const cl::Context& context, const cl::CommandQueue& queue, const cl::Program& program,
+    cl::Buffer& keys, cl::Buffer& vals, unsigned int N, unsigned int bits, bool floatKeys, bool pairs,
+    size_t groupSize) {
+    const size_t tile = groupSize * ITEMS;
+    const unsigned int numTiles = static_cast<unsigned int>((N + tile - 1) / tile);
+    const unsigned int radix = 1u << bits;
+    const unsigned int histCount = radix * numTiles;
+    const unsigned int scanTiles = static_cast<unsigned int>((histCount + tile - 1) / tile);
+
+    cl::Buffer keysTmp(context, CL_MEM_READ_WRITE, N * sizeof(unsigned int));
+    cl::Buffer valsTmp(context, CL_MEM_READ_WRITE, pairs ? N * sizeof(unsigned int) : sizeof(unsigned int));
+    cl::Buffer bufferHist(context, CL_MEM_READ_WRITE, histCount * sizeof(unsigned int));
+    cl::Buffer bufferOffsets(context, CL_MEM_READ_WRITE, histCount * sizeof(unsigned int));
+    cl::Buffer bufferTileSums(context, CL_MEM_READ_WRITE, scanTiles * sizeof(unsigned int));
+
+    cl::Kernel histKernel(program, "digit_histogram");
+    cl::Kernel scatterKernel(program, "scatter");
+    cl::Kernel reduceKernel(program, "tile_reduce");
+    cl::Kernel partialKernel(program, "scan_partial");
+    cl::Kernel scanKernel(program, "tile_scan");
+
+    reduceKernel.setArg(0, bufferHist);
+    reduceKernel.setArg(1, bufferTileSums);
+    reduceKernel.setArg(2, histCount);
+    partialKernel.setArg(0, bufferTileSums);
+    partialKernel.setArg(1, scanTiles);
+    scanKernel.setArg(0, bufferHist);
+    scanKernel.setArg(1, bufferOffsets);
+    scanKernel.setArg(2, bufferTileSums);
+    scanKernel.setArg(3, histCount);
+
+    const cl::NDRange local(groupSize);
+    const cl::NDRange sortGlobal(static_cast<size_t>(numTiles) * groupSize);
+    const cl::NDRange scanGlobal(static_cast<size_t>(scanTiles) * groupSize);
+    const cl::NDRange mapGlobal((N + groupSize - 1) / groupSize * groupSize);
+
+    std::vector<cl::Event> events;
+    auto launch = [&](cl::Kernel& kernel, const cl::NDRange& global) {
+        events.emplace_back();
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events.back());
+    };
+
+    cl::Kernel toKey, toFloat;
+    if (floatKeys) {
+        toKey = cl::Kernel(program, "float_to_key");
+        toKey.setArg(0, keys);
+        toKey.setArg(1, N);
+        launch(toKey, mapGlobal);
+    }
+
+    cl::Buffer* src[2] = { &keys, &vals };
+    cl::Buffer* dst[2] = { &keysTmp, &valsTmp };
+    for (unsigned int shift = 0; shift < 32; shift += bits) {
+        histKernel.setArg(0, *src[0]);
+        histKernel.setArg(1, bufferHist);
+        histKernel.setArg(2, N);
+        histKernel.setArg(3, shift);
+        launch(histKernel, sortGlobal);
+
+        launch(reduceKernel, scanGlobal);
+        launch(partialKernel, local);
+        launch(scanKernel, scanGlobal);
+
+        unsigned int arg = 0;
+        scatterKernel.setArg(arg++, *src[0]);
+        scatterKernel.setArg(arg++, *dst[0]);
+        if (pairs) {
+            scatterKernel.setArg(arg++, *src[1]);
+            scatterKernel.setArg(arg++, *dst[1]);
+        }
+        scatterKernel.setArg(arg++, bufferOffsets);
+        scatterKernel.setArg(arg++, N);
+        scatterKernel.setArg(arg++, shift);
+        launch(scatterKernel, sortGlobal);
+
+        std::swap(src, dst);
+    }
+
+    // An odd pass count leaves the result in the scratch buffers
+    if (src[0] != &keys) {
+        std::swap(keys, keysTmp);
+        std::swap(vals, valsTmp);
+    }
+
+    if (floatKeys) {
+        toFloat = cl::Kernel(program, "key_to_float");
+        toFloat.setArg(0, keys);
+        toFloat.setArg(1, N);
+        launch(toFloat, mapGlobal);
+    }
+    queue.finish();
+
+    cl_ulong ns = 0;
+    for (const auto& e : events) ns += elapsedNs(e);
+    return ns;
+}
+
+// CPU sort
+
+void rand_init(std::vector<unsigned int>& v) {
+    static std::mt19937_64 gen;
+    std::uniform_int_distribution<unsigned int> dist;
+    for (auto& x : v) x = dist(gen);
+}
+
+void rand_init(std::vector<float>& v) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(-1e6f, 1e6f);
+    for (auto& x : v) x = dist(gen);
+}
+
+template<typename K>
+int run_sort(const Config& cfg, const cl::Context& context, const cl::Device& device, const cl::Program& program,
+    size_t groupSize) {
+    const unsigned int N = cfg.N;
+
+    std::vector<K> hostKeys(N);
+    rand_init(hostKeys);
+    std::vector<unsigned int> hostVals(cfg.pairs ? N : 0);
+    std::iota(hostVals.begin(), hostVals.end(), 0u); // payload = original position
+
+    // Reference: a stable sort gives the only valid payload order
+    std::vector<K> sorted_cpu = hostKeys;
+    std::vector<unsigned int> vals_cpu = hostVals;
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    if (cfg.pairs) {
+        std::stable_sort(vals_cpu.begin(), vals_cpu.end(),
+            [&](unsigned int a, unsigned int b) { return hostKeys[a] < hostKeys[b]; });
+        for (unsigned int i = 0; i < N; ++i) sorted_cpu[i] = hostKeys[vals_cpu[i]];
+    }
+    else {
+        std::sort(sorted_cpu.begin(), sorted_cpu.end());
+    }
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    std::vector<K> sorted_par = hostKeys;
+    auto parStart = std::chrono::high_resolution_clock::now();
+    std::sort(std::execution::par, sorted_par.begin(), sorted_par.end());
+    auto parEnd = std::chrono::high_resolution_clock::now();
+    double parTimeMs = std::chrono::duration<double, std::milli>(parEnd - parStart).count();
+
+    cl::Buffer bufferKeys(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        N * sizeof(K), hostKeys.data());
+    cl::Buffer bufferVals = cfg.pairs
+        ? cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, N * sizeof(unsigned int), hostVals.data())
+        : cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(unsigned int));
+
+    cl::CommandQueue queue(context, device, cl::QueueProperties::Profiling);
+
+    auto gpuWallStart = std::chrono::high_resolution_clock::now();
+    cl_ulong gpuKernelNs = radix_sort(context, queue, program, bufferKeys, bufferVals, N, cfg.Bits,
+        cfg.floatKeys, cfg.pairs, groupSize);
+    auto gpuWallEnd = std::chrono::high_resolution_clock::now();
+    double gpuWallTimeMs = std::chrono::duration<double, std::milli>(gpuWallEnd - gpuWallStart).count();
+
+    std::vector<K> sorted_gpu(N);
+    std::vector<unsigned int> vals_gpu(cfg.pairs ? N : 0);
+    cl::copy(queue, bufferKeys, sorted_gpu.begin(), sorted_gpu.end());
+    if (cfg.pairs) cl::copy(queue, bufferVals, vals_gpu.begin(), vals_gpu.end());
+
+    auto report = [&](const char* name, double ms) {
+        std::cout << name << ms << " ms, " << N / (ms * 1e-3) / 1e6 << " Mkeys/s\n";
+    };
+    report("GPU kernel time:  ", gpuKernelNs * 1e-6);
+    std::cout << "GPU wall time:    " << gpuWallTimeMs << " ms\n";
+    report(cfg.pairs ? "CPU stable_sort:  " : "CPU std::sort:    ", cpuTimeMs);
+    report("CPU sort (par):   ", parTimeMs);
+
+    bool correct = (sorted_gpu == sorted_cpu) && (vals_gpu == vals_cpu);
+    std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+
+    std::cout << "Input size: " << cfg.N << "\n";
+    std::cout << "Keys: " << (cfg.floatKeys ? "float" : "uint") << (cfg.pairs ? " + uint payload" : "") << "\n";
+    std::cout << "Radix bits: " << cfg.Bits << " (" << (32 + cfg.Bits - 1) / cfg.Bits << " passes)\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    if ((groupSize & (groupSize - 1)) != 0) {
+        std::cerr << "Work-group size must be a power of two.\n";
+        return EXIT_FAILURE;
+    }
+
+    // scan.cl supplies the tile layout, group_scan and the reduce-then-scan kernels
+    const std::string scanPath = std::filesystem::path(cfg.kernelPath).replace_filename("scan.cl").string();
+    std::string kernelSource = readKernelFile(scanPath) + "\n" + readKernelFile(cfg.kernelPath); /* Read kernels */
+    std::string defines = "#define GROUP_SIZE " + std::to_string(groupSize) + "\n";
+    defines += "#define ITEMS " + std::to_string(ITEMS) + "\n";
+    defines += "#define RADIX_BITS " + std::to_string(cfg.Bits) + "\n";
+    if (cfg.pairs) defines += "#define PAYLOAD\n";
+    kernelSource = defines + kernelSource;
+
+    cl::Program program(context, kernelSource);
+    program.build({ selectedDevice });
+
+    int status = cfg.floatKeys ? run_sort<float>(cfg, context, selectedDevice, program, groupSize)
+                               : run_sort<unsigned int>(cfg, context, selectedDevice, program, groupSize);
+    std::cout << "\ndone. Keys sorted.\n";
+    return status;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* radix_sort OpenCL kernels
+*
+* LSD radix sort of 32-bit keys, RADIX_BITS per pass, tiles of TILE keys (scan.cl is built in front of
+* this file and provides TILE, PAD and group_scan; its reduce-then-scan kernels scan the digit counts):
+*   digit_histogram - per-tile digit counts, stored digit-major: hist[d * tiles + t]
+*   scatter         - stable local sort of the tile by digit (one 1-bit split per bit), then every key
+*                     goes to offsets[d * tiles + t] + its rank among the tile's keys with digit d
+*   float_to_key, key_to_float - order-preserving float <-> uint mapping
+* PAYLOAD moves a uint value with every key.
+*/
+
+/* #define RADIX_BITS 8 */   /*for ocloc offline compilation*/
+
+#define RADIX (1u << RADIX_BITS)
+#define DIGIT(key, shift) (((key) >> (shift)) & (RADIX - 1))
+
+// Negative floats: flip all bits; positive: flip the sign bit. Unsigned order then equals float order.
+__kernel void float_to_key(__global uint* keys, uint n) {
+    const uint i = get_global_id(0);
+    if (i < n) {
+        const uint k = keys[i];
+        keys[i] = (k & 0x80000000u) ? ~k : (k | 0x80000000u);
+    }
+}
+
+__kernel void key_to_float(__global uint* keys, uint n) {
+    const uint i = get_global_id(0);
+    if (i < n) {
+        const uint k = keys[i];
+        keys[i] = (k & 0x80000000u) ? (k & 0x7FFFFFFFu) : ~k;
+    }
+}
+
+__kernel void digit_histogram(__global const uint* keys,
+                              __global uint* groupHist,
+                              uint n,
+                              uint shift) {
+    __local uint hist[RADIX];
+
+    const uint lid = get_local_id(0);
+    const uint group = get_group_id(0);
+
+    for (uint d = lid; d < RADIX; d += GROUP_SIZE) {
+        hist[d] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    const uint base = group * TILE;
+    for (uint k = lid; k < TILE; k += GROUP_SIZE) {
+        const uint g = base + k;
+        if (g < n) {
+            atomic_inc(&hist[DIGIT(keys[g], shift)]);
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // digit-major: one exclusive scan over the whole array yields every tile's scatter offsets
+    for (uint d = lid; d < RADIX; d += GROUP_SIZE) {
+        groupHist[d * get_num_groups(0) + group] = hist[d];
+    }
+}
+
+__kernel void scatter(__global const uint* keysIn,
+                      __global uint* keysOut,
+#ifdef PAYLOAD
+                      __global const uint* valsIn,
+                      __global uint* valsOut,
+#endif
+                      __global const uint* offsets,
+                      uint n,
+                      uint shift) {
+    __local uint lkeys[PAD(TILE)];
+#ifdef PAYLOAD
+    __local uint lvals[PAD(TILE)];
+#endif
+    __local uint tmp[GROUP_SIZE];
+    __local uint digitStart[RADIX];
+    __local uint digitOffset[RADIX];
+
+    const uint lid = get_local_id(0);
+    const uint group = get_group_id(0);
+    const uint base = group * TILE;
+    const uint valid = min((uint)TILE, n - base);
+
+    // striped load; padding keys carry the largest digit and stay behind the real ones
+    for (uint k = lid; k < TILE; k += GROUP_SIZE) {
+        const uint g = base + k;
+        lkeys[PAD(k)] = (g < n) ? keysIn[g] : 0xFFFFFFFFu;
+#ifdef PAYLOAD
+        lvals[PAD(k)] = (g < n) ? valsIn[g] : 0;
+#endif
+    }
+    for (uint d = lid; d < RADIX; d += GROUP_SIZE) {
+        digitOffset[d] = offsets[d * get_num_groups(0) + group];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // stable split on every digit bit, low to high; each work-item owns ITEMS consecutive slots
+    const uint first = lid * ITEMS;
+    for (uint bit = shift; bit < shift + RADIX_BITS && bit < 32; ++bit) {
+        uint key[ITEMS];
+#ifdef PAYLOAD
+        uint val[ITEMS];
+#endif
+        uint zeros = 0;
+        for (uint j = 0; j < ITEMS; ++j) {
+            key[j] = lkeys[PAD(first + j)];
+#ifdef PAYLOAD
+            val[j] = lvals[PAD(first + j)];
+#endif
+            zeros += ((key[j] >> bit) & 1) ^ 1;
+        }
+
+        // group_scan ends on a barrier: every read above is done before the writes below
+        uint totalZeros;
+        uint zerosBefore = group_scan(zeros, tmp, &totalZeros);
+        for (uint j = 0; j < ITEMS; ++j) {
+            uint dst;
+            if ((key[j] >> bit) & 1) {
+                dst = totalZeros + (first + j - zerosBefore); // ones keep their order after all zeros
+            }
+            else {
+                dst = zerosBefore++;
+            }
+            lkeys[PAD(dst)] = key[j];
+#ifdef PAYLOAD
+            lvals[PAD(dst)] = val[j];
+#endif
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // the tile is now grouped by digit: find where every digit starts
+    for (uint k = lid; k < TILE; k += GROUP_SIZE) {
+        const uint d = DIGIT(lkeys[PAD(k)], shift);
+        if (k == 0 || DIGIT(lkeys[PAD(k - 1)], shift) != d) {
+            digitStart[d] = k;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // neighbouring work-items write neighbouring addresses within each digit run
+    for (uint k = lid; k < valid; k += GROUP_SIZE) {
+        const uint key = lkeys[PAD(k)];
+        const uint d = DIGIT(key, shift);
+        const uint dst = digitOffset[d] + (k - digitStart[d]);
+        keysOut[dst] = key;
+#ifdef PAYLOAD
+        valsOut[dst] = lvals[PAD(k)];
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,343 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for parallel reductions: sum, min, max, argmax and dot in float or double.
+* Only the final value leaves the device; throughput is compared with a device buffer copy.
+*
+* ICPX:    icpx reduce.cc -o reduce.exe -O2 -std=c++20 -lOpenCL
+* Usage:   reduce.exe -size=67108864 -type=float (all operations, as a sample)
+*          reduce.exe -op=argmax -type=double
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+enum class ReduceOp { Sum, Min, Max, ArgMax, Dot };
+
+constexpr ReduceOp ALL_OPS[] = { ReduceOp::Sum, ReduceOp::Min, ReduceOp::Max, ReduceOp::ArgMax, ReduceOp::Dot };
+
+const char* opName(ReduceOp op) {
+    switch (op) {
+    case ReduceOp::Sum: return "sum";
+    case ReduceOp::Min: return "min";
+    case ReduceOp::Max: return "max";
+    case ReduceOp::ArgMax: return "argmax";
+    default: return "dot";
+    }
+}
+
+struct Config {
+    unsigned int N = 1 << 26;
+    bool useDouble = false;
+    std::string opName = "all";
+    std::string kernelPath = "reduce.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-type=")) {
+            std::string_view type = arg.substr(6);
+            if (type == "float") cfg.useDouble = false;
+            else if (type == "double") cfg.useDouble = true;
+            else {
+                std::cerr << "Invalid -type value (float|double)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-op=")) {
+            cfg.opName = std::string(arg.substr(4));
+            bool known = (cfg.opName == "all");
+            for (ReduceOp op : ALL_OPS) known = known || (cfg.opName == opName(op));
+            if (!known) {
+                std::cerr << "Invalid -op value (sum|min|max|argmax|dot|all)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+bool hasSubGroups(const cl::Device& device) {
+    const std::string ext = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    return ext.find("cl_khr_subgroups") != std::string::npos || ext.find("cl_intel_subgroups") != std::string::npos;
+}
+
+// Sub-group built-ins are declared for OpenCL C 2.0 and later
+std::string buildOptions(const cl::Device& device) {
+    const std::string version = device.getInfo<CL_DEVICE_OPENCL_C_VERSION>(); // "OpenCL C x.y ..."
+    if (version.starts_with("OpenCL C 3")) return "-cl-std=CL3.0";
+    if (version.starts_with("OpenCL C 2")) return "-cl-std=CL2.0";
+    return "";
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+constexpr unsigned int GROUPS_PER_CU = 4; // persistent groups per compute unit: enough loads in flight to saturate memory
+
+// CPU reductions
+
+template<typename T>
+void rand_init(std::vector<T>& v) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<T> dist(0, 1);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Sums accumulate in double; min, max and argmax are exact in any order
+template<typename T>
+double reduce_ref(ReduceOp op, const std::vector<T>& x, const std::vector<T>& y, unsigned int& index) {
+    index = 0;
+    switch (op) {
+    case ReduceOp::Sum: {
+        double sum = 0.0;
+        for (T v : x) sum += v;
+        return sum;
+    }
+    case ReduceOp::Min:
+        return *std::min_element(x.begin(), x.end());
+    case ReduceOp::Max:
+        return *std::max_element(x.begin(), x.end());
+    case ReduceOp::ArgMax: {
+        auto it = std::max_element(x.begin(), x.end()); // first maximum
+        index = static_cast<unsigned int>(it - x.begin());
+        return *it;
+    }
+    default: {
+        double dot = 0.0;
+        for (size_t i = 0; i < x.size(); ++i) dot += static_cast<double>(x[i]) * y[i];
+        return dot;
+    }
+    }
+}
+
+template<typename T>
+int run_reduce(const Config& cfg, const cl::Device& device, const cl::Context& context) {
+    const unsigned int N = cfg.N;
+    const size_t bytes = static_cast<size_t>(N) * sizeof(T);
+    const char* realName = std::is_same_v<T, double> ? "double" : "float";
+
+    const size_t computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const size_t numGroups = std::min<size_t>(computeUnits * GROUPS_PER_CU, (N + groupSize - 1) / groupSize);
+    const bool subGroups = hasSubGroups(device);
+    std::cout << "Work-groups: " << numGroups << " x " << groupSize
+        << (subGroups ? " (sub-group reduction)" : " (local-memory tree)") << "\n\n";
+
+    std::vector<T> hostX(N);
+    std::vector<T> hostY(N);
+    rand_init(hostX);
+    rand_init(hostY);
+
+    cl::Buffer bufferX(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, hostX.data());
+    cl::Buffer bufferY(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, hostY.data());
+    cl::Buffer bufferPartial(context, CL_MEM_READ_WRITE, numGroups * sizeof(T));
+    cl::Buffer bufferPartialIdx(context, CL_MEM_READ_WRITE, numGroups * sizeof(unsigned int));
+    cl::Buffer bufferResult(context, CL_MEM_READ_WRITE, sizeof(T));
+    cl::Buffer bufferResultIdx(context, CL_MEM_READ_WRITE, sizeof(unsigned int));
+
+    cl::CommandQueue queue(context, device, cl::QueueProperties::Profiling);
+
+    // Reference bandwidth: a device-side copy reads and writes every byte once
+    cl::Buffer bufferCopy(context, CL_MEM_READ_WRITE, bytes);
+    cl::Event copyEvent;
+    queue.enqueueCopyBuffer(bufferX, bufferCopy, 0, 0, bytes, nullptr, &copyEvent);
+    queue.finish();
+    const double copyGBs = 2.0 * bytes / elapsedNs(copyEvent);
+    std::cout << "Copy bandwidth:   " << copyGBs << " GB/s\n\n";
+
+    const std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
+    bool allCorrect = true;
+
+    std::cout << std::left << std::setw(8) << "op" << std::setw(18) << "result"
+        << std::setw(12) << "kernel ms" << std::setw(10) << "GB/s" << std::setw(10) << "of copy"
+        << std::setw(10) << "CPU ms" << "check\n";
+
+    for (ReduceOp op : ALL_OPS) {
+        if (cfg.opName != "all" && cfg.opName != opName(op)) continue;
+
+        std::string defines = "#define REAL " + std::string(realName) + "\n";
+        defines += "#define OP " + std::to_string(static_cast<int>(op)) + "\n";
+        defines += "#define GROUP_SIZE " + std::to_string(groupSize) + "\n";
+        if (std::is_same_v<T, double>) defines += "#define USE_DOUBLE\n";
+        if (subGroups) defines += "#define SUBGROUPS\n";
+
+        cl::Program program(context, defines + kernelSource);
+        program.build({ device }, subGroups ? buildOptions(device).c_str() : "");
+
+        cl::Kernel partialKernel(program, "reduce_partial");
+        partialKernel.setArg(0, bufferX);
+        partialKernel.setArg(1, op == ReduceOp::Dot ? bufferY : bufferX);
+        partialKernel.setArg(2, bufferPartial);
+        partialKernel.setArg(3, bufferPartialIdx);
+        partialKernel.setArg(4, N);
+
+        cl::Kernel finalKernel(program, "reduce_final");
+        finalKernel.setArg(0, bufferPartial);
+        finalKernel.setArg(1, bufferPartialIdx);
+        finalKernel.setArg(2, static_cast<unsigned int>(numGroups));
+        finalKernel.setArg(3, bufferResult);
+        finalKernel.setArg(4, bufferResultIdx);
+
+        cl::Event partialEvent, finalEvent;
+        queue.enqueueNDRangeKernel(partialKernel, cl::NullRange, cl::NDRange(numGroups * groupSize),
+            cl::NDRange(groupSize), nullptr, &partialEvent);
+        queue.enqueueNDRangeKernel(finalKernel, cl::NullRange, cl::NDRange(groupSize),
+            cl::NDRange(groupSize), nullptr, &finalEvent);
+
+        // Device to Host: one value (and index)
+        T gpuValue = 0;
+        unsigned int gpuIndex = 0;
+        queue.enqueueReadBuffer(bufferResult, CL_TRUE, 0, sizeof(T), &gpuValue);
+        queue.enqueueReadBuffer(bufferResultIdx, CL_TRUE, 0, sizeof(unsigned int), &gpuIndex);
+
+        const cl_ulong kernelNs = elapsedNs(partialEvent) + elapsedNs(finalEvent);
+        const size_t bytesRead = (op == ReduceOp::Dot) ? 2 * bytes : bytes;
+        const double gbs = static_cast<double>(bytesRead) / kernelNs;
+
+        unsigned int cpuIndex = 0;
+        auto cpuStart = std::chrono::high_resolution_clock::now();
+        const double cpuValue = reduce_ref(op, hostX, hostY, cpuIndex);
+        auto cpuEnd = std::chrono::high_resolution_clock::now();
+        double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+        // Sums are reassociated on the device: compare with a relative tolerance
+        bool correct;
+        if (op == ReduceOp::Sum || op == ReduceOp::Dot) {
+            const double tolerance = std::is_same_v<T, double> ? 1e-9 : 1e-4;
+            correct = std::abs(gpuValue - cpuValue) <= tolerance * std::abs(cpuValue);
+        }
+        else {
+            correct = (gpuValue == static_cast<T>(cpuValue)) && (op != ReduceOp::ArgMax || gpuIndex == cpuIndex);
+        }
+        allCorrect = allCorrect && correct;
+
+        std::string result = std::to_string(gpuValue);
+        if (op == ReduceOp::ArgMax) result = "[" + std::to_string(gpuIndex) + "] " + result;
+        std::cout << std::left << std::setw(8) << opName(op) << std::setw(18) << result
+            << std::setw(12) << kernelNs * 1e-6 << std::setw(10) << gbs
+            << std::setw(10) << (std::to_string(static_cast<int>(100.0 * gbs / copyGBs)) + "%")
+            << std::setw(10) << cpuTimeMs << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\nResult correctness: " << (allCorrect ? "PASSED" : "FAILED") << "\n";
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+
+    std::cout << "Input size: " << cfg.N << "\n";
+    std::cout << "Element type: " << (cfg.useDouble ? "double" : "float") << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n";
+
+    if (cfg.useDouble && selectedDevice.getInfo<CL_DEVICE_DOUBLE_FP_CONFIG>() == 0) {
+        std::cerr << "Device has no double precision support.\n";
+        return EXIT_FAILURE;
+    }
+
+    int status = cfg.useDouble ? run_reduce<double>(cfg, selectedDevice, context)
+                               : run_reduce<float>(cfg, selectedDevice, context);
+    std::cout << "\ndone. Reductions computed.\n";
+    return status;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* reduce OpenCL kernels
+*
+* Two-pass reduction of n elements to one value:
+*   reduce_partial - persistent groups, grid-stride loop into a private accumulator,
+*                    sub-group reduction (SUBGROUPS) and a local-memory tree, one partial per group
+*   reduce_final   - a single group folds the partials
+* OP selects the operation, REAL the element type (float or double).
+* ARGMAX returns the index of the first maximum.
+*/
+
+/* #define REAL float */   /*for ocloc offline compilation*/
+/* #define OP OP_SUM */
+/* #define GROUP_SIZE 256 */
+
+#define OP_SUM 0
+#define OP_MIN 1
+#define OP_MAX 2
+#define OP_ARGMAX 3
+#define OP_DOT 4
+
+#ifdef USE_DOUBLE
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#if OP == OP_SUM || OP == OP_DOT
+#define IDENTITY ((REAL)0)
+#define COMBINE(a, b) ((a) + (b))
+#define SUB_GROUP_REDUCE sub_group_reduce_add
+#elif OP == OP_MIN
+#define IDENTITY ((REAL)INFINITY)
+#define COMBINE(a, b) fmin(a, b)
+#define SUB_GROUP_REDUCE sub_group_reduce_min
+#else
+#define IDENTITY ((REAL)-INFINITY)
+#define COMBINE(a, b) fmax(a, b)
+#define SUB_GROUP_REDUCE sub_group_reduce_max
+#endif
+
+// lval[a] = lval[a] op lval[b]; for ARGMAX ties go to the smaller index
+inline void combine_local(__local REAL* lval, __local uint* lidx, uint a, uint b) {
+#if OP == OP_ARGMAX
+    if (lval[b] > lval[a] || (lval[b] == lval[a] && lidx[b] < lidx[a])) {
+        lval[a] = lval[b];
+        lidx[a] = lidx[b];
+    }
+#else
+    lval[a] = COMBINE(lval[a], lval[b]);
+#endif
+}
+
+// Reduces (value, idx) over the work-group; the result lands in lval[0] and lidx[0]
+inline void group_reduce(REAL value, uint idx, __local REAL* lval, __local uint* lidx) {
+    const uint lid = get_local_id(0);
+
+#ifdef SUBGROUPS
+    // one entry per sub-group leaves the registers instead of one per work-item
+    const REAL sgValue = SUB_GROUP_REDUCE(value);
+#if OP == OP_ARGMAX
+    const uint sgIdx = sub_group_reduce_min(value == sgValue ? idx : UINT_MAX);
+#else
+    const uint sgIdx = 0;
+#endif
+    if (get_sub_group_local_id() == 0) {
+        lval[get_sub_group_id()] = sgValue;
+        lidx[get_sub_group_id()] = sgIdx;
+    }
+    uint active = get_num_sub_groups();
+#else
+    lval[lid] = value;
+    lidx[lid] = idx;
+    uint active = get_local_size(0);
+#endif
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // tree over the active entries, any count
+    while (active > 1) {
+        const uint half = (active + 1) / 2;
+        if (lid + half < active) {
+            combine_local(lval, lidx, lid, lid + half);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        active = half;
+    }
+}
+
+__kernel void reduce_partial(__global const REAL* x,
+                             __global const REAL* y,
+                             __global REAL* partial,
+                             __global uint* partialIdx,
+                             uint n) {
+    __local REAL lval[GROUP_SIZE];
+    __local uint lidx[GROUP_SIZE];
+
+    REAL acc = IDENTITY;
+    uint accIdx = UINT_MAX;
+    for (uint i = get_global_id(0); i < n; i += get_global_size(0)) {
+#if OP == OP_DOT
+        acc = fma(x[i], y[i], acc);
+#elif OP == OP_ARGMAX
+        // indices grow along the loop, so strict > keeps the first maximum
+        if (x[i] > acc || accIdx == UINT_MAX) {
+            acc = x[i];
+            accIdx = i;
+        }
+#else
+        acc = COMBINE(acc, x[i]);
+#endif
+    }
+
+    group_reduce(acc, accIdx, lval, lidx);
+
+    if (get_local_id(0) == 0) {
+        partial[get_group_id(0)] = lval[0];
+        partialIdx[get_group_id(0)] = lidx[0];
+    }
+}
+
+__kernel void reduce_final(__global const REAL* partial,
+                           __global const uint* partialIdx,
+                           uint count,
+                           __global REAL* result,
+                           __global uint* resultIdx) {
+    __local REAL lval[GROUP_SIZE];
+    __local uint lidx[GROUP_SIZE];
+
+    REAL acc = IDENTITY;
+    uint accIdx = UINT_MAX;
+    for (uint i = get_local_id(0); i < count; i += get_local_size(0)) {
+#if OP == OP_ARGMAX
+        REAL v = partial[i];
+        uint vi = partialIdx[i];
+        if (v > acc || (v == acc && vi < accIdx)) {
+            acc = v;
+            accIdx = vi;
+        }
+#else
+        acc = COMBINE(acc, partial[i]);
+#endif
+    }
+
+    group_reduce(acc, accIdx, lval, lidx);
+
+    if (get_local_id(0) == 0) {
+        result[0] = lval[0];
+        resultIdx[0] = lidx[0];
+    }
+}
\ No newline at end of file
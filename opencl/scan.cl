@@ -0,0 +1,206 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* scan OpenCL kernels
+*
+* Prefix sums of uint arrays, tiles of TILE = GROUP_SIZE * ITEMS elements:
+*   scan_lookback - single pass, decoupled look-back (LOOKBACK, needs OpenCL C 2.0 atomics)
+*   tile_reduce   - reduce-then-scan fallback, pass 1: one sum per tile
+*   scan_partial  - pass 2: exclusive scan of the tile sums
+*   tile_scan     - pass 3: every tile scanned again from its offset
+* INCLUSIVE selects an inclusive scan, exclusive otherwise. Sums wrap modulo 2^32.
+*/
+
+/* #define GROUP_SIZE 256 */   /*for ocloc offline compilation*/
+/* #define ITEMS 8 */
+
+#define TILE (GROUP_SIZE * ITEMS)
+#define PAD(k) ((k) + (k) / 32) // work-item i reads ITEMS consecutive words: spread them over the banks
+
+// Look-back status of a tile
+#define FLAG_NONE 0      // nothing published yet
+#define FLAG_AGGREGATE 1 // aggregate[t] holds the sum of tile t
+#define FLAG_PREFIX 2    // inclusivePrefix[t] holds the sum of tiles 0..t
+
+// Striped (coalesced) load of one tile into local memory, zero past n
+inline void load_tile(__global const uint* input, uint n, uint base, __local uint* tile) {
+    for (uint k = get_local_id(0); k < TILE; k += GROUP_SIZE) {
+        const uint g = base + k;
+        tile[PAD(k)] = (g < n) ? input[g] : 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+inline void store_tile(__global uint* output, uint n, uint base, __local const uint* tile, uint offset) {
+    for (uint k = get_local_id(0); k < TILE; k += GROUP_SIZE) {
+        const uint g = base + k;
+        if (g < n) {
+            output[g] = tile[PAD(k)] + offset;
+        }
+    }
+}
+
+// Exclusive scan of one value per work-item (Hillis-Steele); *total receives the group sum
+inline uint group_scan(uint value, __local uint* tmp, uint* total) {
+    const uint lid = get_local_id(0);
+    tmp[lid] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint offset = 1; offset < GROUP_SIZE; offset *= 2) {
+        uint add = (lid >= offset) ? tmp[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        tmp[lid] += add;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    *total = tmp[GROUP_SIZE - 1];
+    const uint inclusive = tmp[lid];
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return inclusive - value;
+}
+
+// Sum of the tile held in local memory
+inline uint reduce_tile(__local const uint* tile, __local uint* tmp) {
+    const uint base = get_local_id(0) * ITEMS;
+    uint sum = 0;
+    for (uint j = 0; j < ITEMS; ++j) {
+        sum += tile[PAD(base + j)];
+    }
+    uint total;
+    group_scan(sum, tmp, &total);
+    return total;
+}
+
+// Scans the tile in local memory in place, returns the tile sum
+inline uint scan_tile(__local uint* tile, __local uint* tmp) {
+    const uint base = get_local_id(0) * ITEMS;
+    uint sum = 0;
+    for (uint j = 0; j < ITEMS; ++j) {
+        sum += tile[PAD(base + j)];
+    }
+
+    uint total;
+    uint running = group_scan(sum, tmp, &total);
+    for (uint j = 0; j < ITEMS; ++j) {
+        const uint x = tile[PAD(base + j)];
+#ifdef INCLUSIVE
+        tile[PAD(base + j)] = running + x;
+#else
+        tile[PAD(base + j)] = running;
+#endif
+        running += x;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return total;
+}
+
+#ifdef LOOKBACK
+// One launch, one group per tile. Tiles are numbered in the order groups start, so every predecessor
+// a group waits for is already running; each tile reads its input once and writes its output once.
+__kernel void scan_lookback(__global const uint* input,
+                            __global uint* output,
+                            uint n,
+                            __global atomic_uint* tileCounter,
+                            __global atomic_uint* flags,
+                            __global uint* aggregate,
+                            __global uint* inclusivePrefix) {
+    __local uint tile[PAD(TILE)];
+    __local uint tmp[GROUP_SIZE];
+    __local uint tileId;
+    __local uint tilePrefix;
+
+    const uint lid = get_local_id(0);
+    if (lid == 0) {
+        tileId = atomic_fetch_add_explicit(tileCounter, 1, memory_order_relaxed, memory_scope_device);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    const uint t = tileId;
+    const uint base = t * TILE;
+
+    load_tile(input, n, base, tile);
+    const uint total = scan_tile(tile, tmp);
+
+    if (lid == 0) {
+        uint exclusive = 0;
+        if (t == 0) {
+            inclusivePrefix[0] = total;
+            atomic_store_explicit(&flags[0], FLAG_PREFIX, memory_order_release, memory_scope_device);
+        }
+        else {
+            // publish the aggregate first so that successors need not wait for our look-back
+            aggregate[t] = total;
+            atomic_store_explicit(&flags[t], FLAG_AGGREGATE, memory_order_release, memory_scope_device);
+
+            uint pred = t - 1;
+            for (;;) {
+                const uint flag = atomic_load_explicit(&flags[pred], memory_order_acquire, memory_scope_device);
+                if (flag == FLAG_PREFIX) {
+                    exclusive += inclusivePrefix[pred];
+                    break;
+                }
+                if (flag == FLAG_AGGREGATE) {
+                    exclusive += aggregate[pred];
+                    --pred; // tile 0 always ends with FLAG_PREFIX
+                }
+                // FLAG_NONE: the predecessor has not reduced its tile yet, spin
+            }
+
+            inclusivePrefix[t] = exclusive + total;
+            atomic_store_explicit(&flags[t], FLAG_PREFIX, memory_order_release, memory_scope_device);
+        }
+        tilePrefix = exclusive;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    store_tile(output, n, base, tile, tilePrefix);
+}
+#endif
+
+// Reduce-then-scan, pass 1: tileSums[t] = sum of tile t
+__kernel void tile_reduce(__global const uint* input,
+                          __global uint* tileSums,
+                          uint n) {
+    __local uint tile[PAD(TILE)];
+    __local uint tmp[GROUP_SIZE];
+
+    const uint t = get_group_id(0);
+    load_tile(input, n, t * TILE, tile);
+    const uint total = reduce_tile(tile, tmp);
+    if (get_local_id(0) == 0) {
+        tileSums[t] = total;
+    }
+}
+
+// Pass 2: a single group turns the tile sums into exclusive tile offsets, in place
+__kernel void scan_partial(__global uint* tileSums,
+                           uint count) {
+    __local uint tmp[GROUP_SIZE];
+
+    uint carry = 0;
+    for (uint base = 0; base < count; base += GROUP_SIZE) {
+        const uint i = base + get_local_id(0);
+        const uint value = (i < count) ? tileSums[i] : 0;
+        uint total;
+        const uint prefix = group_scan(value, tmp, &total);
+        if (i < count) {
+            tileSums[i] = carry + prefix;
+        }
+        carry += total;
+    }
+}
+
+// Pass 3: scan every tile again, starting from its offset
+__kernel void tile_scan(__global const uint* input,
+                        __global uint* output,
+                        __global const uint* tileOffsets,
+                        uint n) {
+    __local uint tile[PAD(TILE)];
+    __local uint tmp[GROUP_SIZE];
+
+    const uint t = get_group_id(0);
+    const uint base = t * TILE;
+    load_tile(input, n, base, tile);
+    scan_tile(tile, tmp);
+    store_tile(output, n, base, tile, tileOffsets[t]);
+}
\ No newline at end of file
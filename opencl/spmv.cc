@@ -0,0 +1,494 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for the sparse matrix-vector product y = A * x with A in CSR.
+* The matrix comes from a Matrix Market (.mtx) file or is generated; three kernels are compared
+* (scalar row, vector row, merge-path) and one is picked from the row-length distribution.
+*
+* ICPX:    icpx spmv.cc -o spmv.exe -O2 -std=c++20 -lOpenCL
+* Usage:   spmv.exe -size=1048576 -nnz=16 (uniform rows, as a sample)
+*          spmv.exe -size=1048576 -nnz=16 -powerlaw -mode=auto
+*          spmv.exe -input=matrix.mtx
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cctype>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+enum class SpmvKernel { Scalar, Vector, Merge };
+
+constexpr SpmvKernel ALL_KERNELS[] = { SpmvKernel::Scalar, SpmvKernel::Vector, SpmvKernel::Merge };
+
+const char* kernelName(SpmvKernel kernel) {
+    switch (kernel) {
+    case SpmvKernel::Scalar: return "scalar";
+    case SpmvKernel::Vector: return "vector";
+    default: return "merge";
+    }
+}
+
+struct Config {
+    unsigned int N = 1 << 20;       // rows = columns of a generated matrix
+    unsigned int NnzPerRow = 16;    // mean nonzeros per generated row
+    bool powerLaw = false;          // heavy-tailed row lengths instead of uniform ones
+    std::string mode = "all";       // auto|scalar|vector|merge|all
+    std::string inputPath = "";
+    std::string kernelPath = "spmv.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-nnz=")) {
+            auto res = std::from_chars(arg.data() + 5, arg.data() + arg.size(), cfg.NnzPerRow);
+            if (res.ec != std::errc{} || cfg.NnzPerRow == 0) {
+                std::cerr << "Invalid -nnz value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-powerlaw") {
+            cfg.powerLaw = true;
+        }
+        else if (arg.starts_with("-mode=")) {
+            cfg.mode = std::string(arg.substr(6));
+            bool known = (cfg.mode == "auto" || cfg.mode == "all");
+            for (SpmvKernel kernel : ALL_KERNELS) known = known || (cfg.mode == kernelName(kernel));
+            if (!known) {
+                std::cerr << "Invalid -mode value (auto|scalar|vector|merge|all)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-input=")) {
+            cfg.inputPath = std::string(arg.substr(7));
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+bool hasSubGroups(const cl::Device& device) {
+    const std::string ext = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    return ext.find("cl_khr_subgroups") != std::string::npos || ext.find("cl_intel_subgroups") != std::string::npos;
+}
+
+// Sub-group built-ins are declared for OpenCL C 2.0 and later
+std::string buildOptions(const cl::Device& device) {
+    const std::string version = device.getInfo<CL_DEVICE_OPENCL_C_VERSION>(); // "OpenCL C x.y ..."
+    if (version.starts_with("OpenCL C 3")) return "-cl-std=CL3.0";
+    if (version.starts_with("OpenCL C 2")) return "-cl-std=CL2.0";
+    return "";
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+constexpr unsigned int GROUPS_PER_CU = 8; // persistent groups per compute unit for the row kernels
+constexpr unsigned int LANES = 32;        // work-items per row in spmv_vector without sub-groups
+constexpr unsigned int ITEMS = 8;         // merge-path steps per work-item
+
+// SPARSE MATRIX
+
+struct CsrMatrix {
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    std::vector<unsigned int> rowPtr;   // rows + 1
+    std::vector<unsigned int> colIdx;   // nnz, ascending within a row
+    std::vector<float> vals;            // nnz
+};
+
+// Sorts (row, col, val) triplets by row and column and compresses the rows
+void coo_to_csr(unsigned int rows, unsigned int cols, const std::vector<unsigned int>& cooRow,
+    const std::vector<unsigned int>& cooCol, const std::vector<float>& cooVal, CsrMatrix& m) {
+    std::vector<size_t> order(cooRow.size());
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return cooRow[a] != cooRow[b] ? cooRow[a] < cooRow[b] : cooCol[a] < cooCol[b];
+    });
+
+    m.rows = rows;
+    m.cols = cols;
+    m.rowPtr.assign(rows + 1, 0);
+    m.colIdx.resize(order.size());
+    m.vals.resize(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        m.rowPtr[cooRow[order[i]] + 1]++;
+        m.colIdx[i] = cooCol[order[i]];
+        m.vals[i] = cooVal[order[i]];
+    }
+    std::partial_sum(m.rowPtr.begin(), m.rowPtr.end(), m.rowPtr.begin());
+}
+
+// Matrix Market coordinate format: real, integer or pattern; general, symmetric or skew-symmetric.
+// Entries are 1-based; symmetric storage keeps one triangle, the other is mirrored here.
+bool readMatrixMarket(const std::string& path, CsrMatrix& m) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(file, line)) return false;
+    for (char& c : line) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    std::istringstream header(line);
+    std::string banner, object, format, field, symmetry;
+    header >> banner >> object >> format >> field >> symmetry;
+    if (banner != "%%matrixmarket" || object != "matrix" || format != "coordinate") return false;
+    if (field != "real" && field != "double" && field != "integer" && field != "pattern") return false;
+    if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric") return false;
+    const bool pattern = (field == "pattern");
+
+    while (std::getline(file, line) && (line.empty() || line[0] == '%')) {}
+    unsigned long long rows = 0, cols = 0, entries = 0;
+    if (!(std::istringstream(line) >> rows >> cols >> entries)) return false;
+    if (rows == 0 || cols == 0 || rows > 0xFFFFFFFEull || cols > 0xFFFFFFFFull) return false;
+
+    std::vector<unsigned int> cooRow, cooCol;
+    std::vector<float> cooVal;
+    cooRow.reserve(entries);
+    cooCol.reserve(entries);
+    cooVal.reserve(entries);
+    for (unsigned long long e = 0; e < entries; ++e) {
+        unsigned long long i = 0, j = 0;
+        double v = 1.0;
+        if (!(file >> i >> j)) return false;
+        if (!pattern && !(file >> v)) return false;
+        if (i == 0 || j == 0 || i > rows || j > cols) return false;
+        cooRow.push_back(static_cast<unsigned int>(i - 1));
+        cooCol.push_back(static_cast<unsigned int>(j - 1));
+        cooVal.push_back(static_cast<float>(v));
+        if (symmetry != "general" && i != j) {
+            cooRow.push_back(static_cast<unsigned int>(j - 1));
+            cooCol.push_back(static_cast<unsigned int>(i - 1));
+            cooVal.push_back(static_cast<float>(symmetry == "symmetric" ? v : -v));
+        }
+    }
+    if (cooRow.size() > 0xFFFFFFFFull) return false; // 32-bit offsets on the device
+
+    coo_to_csr(static_cast<unsigned int>(rows), static_cast<unsigned int>(cols), cooRow, cooCol, cooVal, m);
+    return true;
+}
+
+// Square matrix with random columns; uniform row lengths in [1, 2 * mean), or Pareto (alpha 1.5) lengths
+void synth_csr(unsigned int n, unsigned int mean, bool powerLaw, CsrMatrix& m) {
+    static std::mt19937_64 gen;
+    std::uniform_int_distribution<unsigned int> uniformLen(1, 2 * mean - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<unsigned int> column(0, n - 1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    m.rows = n;
+    m.cols = n;
+    m.rowPtr.assign(n + 1, 0);
+    m.colIdx.clear();
+    m.vals.clear();
+    std::vector<unsigned int> rowCols;
+    for (unsigned int r = 0; r < n; ++r) {
+        unsigned int len = uniformLen(gen);
+        if (powerLaw) {
+            const double xm = mean / 3.0; // Pareto mean = xm * alpha / (alpha - 1)
+            len = static_cast<unsigned int>(std::min<double>(n, std::ceil(xm * std::pow(1.0 - unit(gen), -1.0 / 1.5))));
+        }
+        rowCols.resize(len);
+        for (auto& c : rowCols) c = column(gen);
+        std::sort(rowCols.begin(), rowCols.end());
+        rowCols.erase(std::unique(rowCols.begin(), rowCols.end()), rowCols.end());
+        for (unsigned int c : rowCols) {
+            m.colIdx.push_back(c);
+            m.vals.push_back(value(gen));
+        }
+        m.rowPtr[r + 1] = static_cast<unsigned int>(m.colIdx.size());
+    }
+}
+
+struct RowStats {
+    double mean = 0.0;
+    double cv = 0.0;        // standard deviation / mean
+    unsigned int maxLen = 0;
+};
+
+RowStats row_stats(const CsrMatrix& m) {
+    RowStats s;
+    s.mean = static_cast<double>(m.colIdx.size()) / m.rows;
+    double var = 0.0;
+    for (unsigned int r = 0; r < m.rows; ++r) {
+        const unsigned int len = m.rowPtr[r + 1] - m.rowPtr[r];
+        s.maxLen = std::max(s.maxLen, len);
+        var += (len - s.mean) * (len - s.mean);
+    }
+    s.cv = (s.mean > 0.0) ? std::sqrt(var / m.rows) / s.mean : 0.0;
+    return s;
+}
+
+// Skewed rows leave row-per-worker kernels waiting on the longest row: merge-path splits work evenly.
+// Otherwise a row needs about half a sub-group of nonzeros before lanes per row beat one work-item per row.
+SpmvKernel pick_kernel(const RowStats& s) {
+    if (s.cv > 1.0 || s.maxLen > 64 * s.mean + 64) return SpmvKernel::Merge;
+    if (s.mean >= 12.0) return SpmvKernel::Vector;
+    return SpmvKernel::Scalar;
+}
+
+// CPU SpMV: double accumulation; also the row sums of |a * x| that bound the rounding error
+void spmv_ref(const CsrMatrix& m, const std::vector<float>& x, std::vector<double>& y, std::vector<double>& yAbs) {
+    for (unsigned int r = 0; r < m.rows; ++r) {
+        double sum = 0.0;
+        double sumAbs = 0.0;
+        for (unsigned int j = m.rowPtr[r]; j < m.rowPtr[r + 1]; ++j) {
+            const double p = static_cast<double>(m.vals[j]) * x[m.colIdx[j]];
+            sum += p;
+            sumAbs += std::abs(p);
+        }
+        y[r] = sum;
+        yAbs[r] = sumAbs;
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+
+    CsrMatrix A;
+    if (!cfg.inputPath.empty()) {
+        if (!readMatrixMarket(cfg.inputPath, A)) {
+            std::cerr << "Failed to read Matrix Market coordinate file: " << cfg.inputPath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    else {
+        synth_csr(cfg.N, cfg.NnzPerRow, cfg.powerLaw, A);
+    }
+    const unsigned int rows = A.rows;
+    if (A.rows + static_cast<unsigned long long>(A.colIdx.size()) > 0xFFFFFFFFull) {
+        std::cerr << "Matrix too large: the merge-path kernel counts rows + nnz in 32 bits\n";
+        return EXIT_FAILURE;
+    }
+    const unsigned int nnz = static_cast<unsigned int>(A.colIdx.size());
+    const RowStats stats = row_stats(A);
+    const SpmvKernel autoKernel = pick_kernel(stats);
+
+    std::cout << "Matrix: " << (cfg.inputPath.empty() ? (cfg.powerLaw ? "generated, power-law rows" : "generated, uniform rows")
+        : cfg.inputPath) << "\n";
+    std::cout << "Size: " << rows << " x " << A.cols << ", nnz " << nnz
+        << " (" << 100.0 * nnz / (static_cast<double>(rows) * A.cols) << "% dense)\n";
+    std::cout << "Row length: mean " << stats.mean << ", max " << stats.maxLen << ", cv " << stats.cv << "\n";
+    std::cout << "Auto kernel: " << kernelName(autoKernel) << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n";
+
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const bool subGroups = hasSubGroups(selectedDevice);
+    std::cout << "Vector kernel: " << (subGroups ? "one sub-group per row" : "local-memory tree per row") << "\n\n";
+
+    std::string defines = "#define GROUP_SIZE " + std::to_string(groupSize) + "\n";
+    defines += "#define LANES " + std::to_string(LANES) + "\n";
+    defines += "#define ITEMS " + std::to_string(ITEMS) + "\n";
+    if (subGroups) defines += "#define SUBGROUPS\n";
+
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice }, subGroups ? buildOptions(selectedDevice).c_str() : "");
+
+    std::vector<float> hostX(A.cols);
+    std::vector<float> hostY(rows);
+    {
+        std::mt19937_64 gen;
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        for (auto& v : hostX) v = dist(gen);
+    }
+
+    std::vector<double> refY(rows), refAbs(rows);
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    spmv_ref(A, hostX, refY, refAbs);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    // empty matrices still get valid buffers
+    cl::Buffer bufferRowPtr(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        A.rowPtr.size() * sizeof(unsigned int), A.rowPtr.data());
+    cl::Buffer bufferColIdx(context, CL_MEM_READ_ONLY, std::max<size_t>(1, nnz) * sizeof(unsigned int));
+    cl::Buffer bufferVals(context, CL_MEM_READ_ONLY, std::max<size_t>(1, nnz) * sizeof(float));
+    cl::Buffer bufferX(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, hostX.size() * sizeof(float), hostX.data());
+    cl::Buffer bufferY(context, CL_MEM_WRITE_ONLY, rows * sizeof(float));
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+    if (nnz > 0) {
+        queue.enqueueWriteBuffer(bufferColIdx, CL_FALSE, 0, nnz * sizeof(unsigned int), A.colIdx.data());
+        queue.enqueueWriteBuffer(bufferVals, CL_FALSE, 0, nnz * sizeof(float), A.vals.data());
+    }
+
+    // Merge-path: one carry per work-item
+    const size_t mergeItems = (static_cast<size_t>(rows) + nnz + ITEMS - 1) / ITEMS;
+    const size_t mergeGlobal = (mergeItems + groupSize - 1) / groupSize * groupSize;
+    cl::Buffer bufferCarryRow(context, CL_MEM_READ_WRITE, mergeGlobal * sizeof(unsigned int));
+    cl::Buffer bufferCarryVal(context, CL_MEM_READ_WRITE, mergeGlobal * sizeof(float));
+
+    // Minimum traffic: CSR arrays once, x and y once each
+    const double bytes = (rows + 1.0) * sizeof(unsigned int) + nnz * (sizeof(unsigned int) + sizeof(float))
+        + A.cols * sizeof(float) + rows * sizeof(float);
+    const double flops = 2.0 * nnz;
+
+    bool allCorrect = true;
+    std::cout << std::left << std::setw(10) << "kernel" << std::setw(12) << "kernel ms"
+        << std::setw(10) << "GFLOPS" << std::setw(10) << "GB/s" << "check\n";
+
+    for (SpmvKernel variant : ALL_KERNELS) {
+        if (cfg.mode == "auto" && variant != autoKernel) continue;
+        if (cfg.mode != "auto" && cfg.mode != "all" && cfg.mode != kernelName(variant)) continue;
+
+        cl::Kernel kernel(program, variant == SpmvKernel::Merge ? "spmv_merge"
+            : variant == SpmvKernel::Vector ? "spmv_vector" : "spmv_scalar");
+        kernel.setArg(0, bufferRowPtr);
+        kernel.setArg(1, bufferColIdx);
+        kernel.setArg(2, bufferVals);
+        kernel.setArg(3, bufferX);
+        kernel.setArg(4, bufferY);
+        kernel.setArg(5, rows);
+
+        cl_ulong kernelNs = 0;
+        if (variant == SpmvKernel::Merge) {
+            kernel.setArg(6, bufferCarryRow);
+            kernel.setArg(7, bufferCarryVal);
+
+            cl::Kernel fixupKernel(program, "spmv_fixup");
+            fixupKernel.setArg(0, bufferCarryRow);
+            fixupKernel.setArg(1, bufferCarryVal);
+            fixupKernel.setArg(2, static_cast<unsigned int>(mergeGlobal));
+            fixupKernel.setArg(3, rows);
+            fixupKernel.setArg(4, bufferY);
+
+            cl::Event mergeEvent, fixupEvent;
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(mergeGlobal), cl::NDRange(groupSize),
+                nullptr, &mergeEvent);
+            queue.enqueueNDRangeKernel(fixupKernel, cl::NullRange, cl::NDRange(mergeGlobal), cl::NDRange(groupSize),
+                nullptr, &fixupEvent);
+            queue.finish();
+            kernelNs = elapsedNs(mergeEvent) + elapsedNs(fixupEvent);
+        }
+        else {
+            // persistent groups; the vector kernel wants enough work-items to give every row its lanes
+            const size_t perRow = (variant == SpmvKernel::Vector) ? LANES : 1;
+            const size_t numGroups = std::max<size_t>(1, std::min<size_t>(computeUnits * GROUPS_PER_CU,
+                (static_cast<size_t>(rows) * perRow + groupSize - 1) / groupSize));
+
+            cl::Event event;
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(numGroups * groupSize), cl::NDRange(groupSize),
+                nullptr, &event);
+            queue.finish();
+            kernelNs = elapsedNs(event);
+        }
+
+        queue.enqueueReadBuffer(bufferY, CL_TRUE, 0, rows * sizeof(float), hostY.data());
+        bool correct = true;
+        for (unsigned int r = 0; r < rows && correct; ++r) {
+            correct = std::abs(hostY[r] - refY[r]) <= 1e-4 * refAbs[r] + 1e-6;
+        }
+        allCorrect = allCorrect && correct;
+
+        std::string name = kernelName(variant);
+        if (variant == autoKernel) name += " *";
+        std::cout << std::left << std::setw(10) << name << std::setw(12) << kernelNs * 1e-6
+            << std::setw(10) << flops / kernelNs << std::setw(10) << bytes / kernelNs
+            << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\n* picked automatically\n";
+    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "\nResult correctness: " << (allCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Sparse matrix-vector product computed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
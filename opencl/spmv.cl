@@ -0,0 +1,173 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* spmv OpenCL kernels
+*
+* y = A * x for A in CSR (rowPtr[rows + 1], colIdx[nnz], vals[nnz]):
+*   spmv_scalar - one work-item per row: best for short, even rows
+*   spmv_vector - one sub-group per row (SUBGROUPS), else LANES work-items per row with a local tree:
+*                 neighbouring lanes read neighbouring nonzeros, best for long rows
+*   spmv_merge  - merge-path: the rows + nnz steps of merging row ends with nonzero indices are split
+*                 evenly, ITEMS per work-item, whatever the row lengths; rows left open at the end of a
+*                 range go to carry[], spmv_fixup adds them
+* The scalar and vector row loops are grid-stride, so the host launches persistent groups for them.
+*/
+
+/* #define GROUP_SIZE 256 */   /*for ocloc offline compilation*/
+/* #define LANES 32 */
+/* #define ITEMS 8 */
+
+__kernel void spmv_scalar(__global const uint* rowPtr,
+                          __global const uint* colIdx,
+                          __global const float* vals,
+                          __global const float* x,
+                          __global float* y,
+                          uint rows) {
+    for (uint row = get_global_id(0); row < rows; row += get_global_size(0)) {
+        float sum = 0.0f;
+        const uint end = rowPtr[row + 1];
+        for (uint j = rowPtr[row]; j < end; ++j) {
+            sum = fma(vals[j], x[colIdx[j]], sum);
+        }
+        y[row] = sum;
+    }
+}
+
+#ifdef SUBGROUPS
+
+__kernel void spmv_vector(__global const uint* rowPtr,
+                          __global const uint* colIdx,
+                          __global const float* vals,
+                          __global const float* x,
+                          __global float* y,
+                          uint rows) {
+    const uint lanes = get_sub_group_size();
+    const uint lane = get_sub_group_local_id();
+    const uint stride = get_num_groups(0) * get_num_sub_groups();
+
+    // the loop bound is uniform across the sub-group, as sub_group_reduce_add requires
+    for (uint row = get_group_id(0) * get_num_sub_groups() + get_sub_group_id(); row < rows; row += stride) {
+        float sum = 0.0f;
+        const uint end = rowPtr[row + 1];
+        for (uint j = rowPtr[row] + lane; j < end; j += lanes) {
+            sum = fma(vals[j], x[colIdx[j]], sum);
+        }
+        sum = sub_group_reduce_add(sum);
+        if (lane == 0) {
+            y[row] = sum;
+        }
+    }
+}
+
+#else
+
+__kernel void spmv_vector(__global const uint* rowPtr,
+                          __global const uint* colIdx,
+                          __global const float* vals,
+                          __global const float* x,
+                          __global float* y,
+                          uint rows) {
+    __local float partial[GROUP_SIZE];
+
+    const uint lid = get_local_id(0);
+    const uint lane = lid % LANES;
+    const uint rowsPerGroup = GROUP_SIZE / LANES;
+    const uint stride = get_num_groups(0) * rowsPerGroup;
+
+    // uniform bound across the group: every work-item reaches every barrier
+    for (uint base = get_group_id(0) * rowsPerGroup; base < rows; base += stride) {
+        const uint row = base + lid / LANES;
+        float sum = 0.0f;
+        if (row < rows) {
+            const uint end = rowPtr[row + 1];
+            for (uint j = rowPtr[row] + lane; j < end; j += LANES) {
+                sum = fma(vals[j], x[colIdx[j]], sum);
+            }
+        }
+        partial[lid] = sum;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (uint offset = LANES / 2; offset > 0; offset /= 2) {
+            if (lane < offset) {
+                partial[lid] += partial[lid + offset];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+        if (lane == 0 && row < rows) {
+            y[row] = partial[lid];
+        }
+    }
+}
+
+#endif
+
+// Rows consumed at merge-path diagonal diag: the split between row ends rowPtr[1..rows] and 0..nnz-1
+inline uint merge_path_search(__global const uint* rowPtr, uint rows, uint nnz, uint diag) {
+    uint lo = (diag > nnz) ? diag - nnz : 0;
+    uint hi = min(diag, rows);
+    while (lo < hi) {
+        const uint pivot = (lo + hi) / 2;
+        if (rowPtr[pivot + 1] <= diag - pivot - 1) {
+            lo = pivot + 1;
+        }
+        else {
+            hi = pivot;
+        }
+    }
+    return lo;
+}
+
+__kernel void spmv_merge(__global const uint* rowPtr,
+                         __global const uint* colIdx,
+                         __global const float* vals,
+                         __global const float* x,
+                         __global float* y,
+                         uint rows,
+                         __global uint* carryRow,
+                         __global float* carryVal) {
+    const uint nnz = rowPtr[rows];
+    const uint total = rows + nnz;
+    const uint t = get_global_id(0);
+    const uint begin = min(t * ITEMS, total);
+    const uint end = min(begin + ITEMS, total);
+
+    uint row = merge_path_search(rowPtr, rows, nnz, begin);
+    uint j = begin - row;
+    float sum = 0.0f;
+
+    // every step either consumes a nonzero of the current row or closes the row
+    for (uint step = begin; step < end; ++step) {
+        if (j < rowPtr[row + 1]) {
+            sum = fma(vals[j], x[colIdx[j]], sum);
+            ++j;
+        }
+        else {
+            y[row] = sum; // the part before this range, if any, comes from carries
+            sum = 0.0f;
+            ++row;
+        }
+    }
+
+    carryRow[t] = row; // row == rows: nothing left open
+    carryVal[t] = sum;
+}
+
+// Carries of consecutive work-items can hit the same long row: the first of each run sums the run
+__kernel void spmv_fixup(__global const uint* carryRow,
+                         __global const float* carryVal,
+                         uint count,
+                         uint rows,
+                         __global float* y) {
+    const uint t = get_global_id(0);
+    if (t >= count) return;
+
+    const uint row = carryRow[t];
+    if (row >= rows || (t > 0 && carryRow[t - 1] == row)) return;
+
+    float sum = 0.0f;
+    for (uint i = t; i < count && carryRow[i] == row; ++i) {
+        sum += carryVal[i];
+    }
+    y[row] += sum;
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for iterative 2D stencils (Jacobi sweeps) with 5-point or 9-point coefficients.
+* The grid stays on the device in two ping-pong buffers for all iterations; every launch runs several
+* sweeps inside local-memory tiles with halos (temporal blocking). Depths are compared in Mcells/s.
+*
+* ICPX:    icpx stencil.cc -o stencil.exe -O2 -std=c++20 -lOpenCL
+* Usage:   stencil.exe -width=2048 -height=2048 -iters=64 -points=5 (depth sweep, as a sample)
+*          stencil.exe -points=9 -steps=4
+*          stencil.exe -coeff=0.05,0.2,0.05,0.2,0,0.2,0.05,0.2,0.05 (row-major 3 x 3)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int Width = 2048;
+    unsigned int Height = 2048;
+    unsigned int Iters = 64;
+    unsigned int Points = 5;                             // 5 or 9
+    std::vector<unsigned int> depths = { 1, 2, 4, 8 };   // sweeps per launch
+    std::vector<float> coeff;                            // 9 values; empty: Jacobi defaults
+    std::string kernelPath = "stencil.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-width=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.Width);
+            if (res.ec != std::errc{} || cfg.Width < 3) {
+                std::cerr << "Invalid -width value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-height=")) {
+            auto res = std::from_chars(arg.data() + 8, arg.data() + arg.size(), cfg.Height);
+            if (res.ec != std::errc{} || cfg.Height < 3) {
+                std::cerr << "Invalid -height value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-iters=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.Iters);
+            if (res.ec != std::errc{} || cfg.Iters == 0) {
+                std::cerr << "Invalid -iters value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-points=")) {
+            auto res = std::from_chars(arg.data() + 8, arg.data() + arg.size(), cfg.Points);
+            if (res.ec != std::errc{} || (cfg.Points != 5 && cfg.Points != 9)) {
+                std::cerr << "Invalid -points value (5|9)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-steps=")) {
+            unsigned int steps = 0;
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), steps);
+            if (res.ec != std::errc{} || steps == 0 || steps > 16) {
+                std::cerr << "Invalid -steps value (1..16)\n";
+                std::exit(EXIT_FAILURE);
+            }
+            cfg.depths = { steps };
+        }
+        else if (arg.starts_with("-coeff=")) {
+            cfg.coeff.clear();
+            const char* p = arg.data() + 7;
+            const char* end = arg.data() + arg.size();
+            while (p < end) {
+                float c = 0.0f;
+                auto res = std::from_chars(p, end, c);
+                if (res.ec != std::errc{} || (res.ptr != end && *res.ptr != ',')) {
+                    std::cerr << "Invalid -coeff value\n";
+                    std::exit(EXIT_FAILURE);
+                }
+                cfg.coeff.push_back(c);
+                p = (res.ptr == end) ? end : res.ptr + 1;
+            }
+            if (cfg.coeff.size() != 9) {
+                std::cerr << "Invalid -coeff value (9 comma-separated values, row-major 3 x 3)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    // Jacobi for the Laplace equation: 5-point average of the neighbours, or the 9-point (4 * edges + corners) / 20
+    if (cfg.coeff.empty()) {
+        cfg.coeff = (cfg.Points == 5) ? std::vector<float>{ 0.0f, 0.25f, 0.0f, 0.25f, 0.0f, 0.25f, 0.0f, 0.25f, 0.0f }
+                                      : std::vector<float>{ 0.05f, 0.2f, 0.05f, 0.2f, 0.0f, 0.2f, 0.05f, 0.2f, 0.05f };
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+constexpr unsigned int TILE_X = 32;   // output tile = work-group
+constexpr unsigned int TILE_Y = 8;
+
+// CPU stencil
+
+void rand_init(std::vector<float>& v) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Same term order as stencil.cl; the boundary ring is copied unchanged
+void stencil_ref(std::vector<float>& grid, unsigned int width, unsigned int height, unsigned int iters,
+    const std::vector<float>& c, unsigned int points) {
+    std::vector<float> next(grid);
+    for (unsigned int it = 0; it < iters; ++it) {
+        for (unsigned int y = 1; y + 1 < height; ++y) {
+            for (unsigned int x = 1; x + 1 < width; ++x) {
+                const size_t i = static_cast<size_t>(y) * width + x;
+                float v = c[1] * grid[i - width] + c[3] * grid[i - 1] + c[4] * grid[i]
+                        + c[5] * grid[i + 1] + c[7] * grid[i + width];
+                if (points == 9) {
+                    v += c[0] * grid[i - width - 1] + c[2] * grid[i - width + 1]
+                       + c[6] * grid[i + width - 1] + c[8] * grid[i + width + 1];
+                }
+                next[i] = v;
+            }
+        }
+        grid.swap(next);
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int width = cfg.Width;
+    const unsigned int height = cfg.Height;
+    const size_t cells = static_cast<size_t>(width) * height;
+
+    std::cout << "Grid: " << width << " x " << height << ", " << cfg.Iters << " iterations\n";
+    std::cout << "Stencil: " << cfg.Points << "-point, coefficients";
+    for (float c : cfg.coeff) std::cout << " " << c;
+    std::cout << "\nKernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    if (selectedDevice.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>() < TILE_X * TILE_Y) {
+        std::cerr << "Work-group of " << TILE_X * TILE_Y << " not supported by the device.\n";
+        return EXIT_FAILURE;
+    }
+    const cl_ulong localMem = selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+
+    std::vector<float> hostInit(cells);
+    std::vector<float> hostGrid(cells);
+    rand_init(hostInit);
+
+    std::vector<float> hostRef(hostInit);
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    stencil_ref(hostRef, width, height, cfg.Iters, cfg.coeff, cfg.Points);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    cl::Buffer bufferInit(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cells * sizeof(float), hostInit.data());
+    cl::Buffer bufferPing(context, CL_MEM_READ_WRITE, cells * sizeof(float));
+    cl::Buffer bufferPong(context, CL_MEM_READ_WRITE, cells * sizeof(float));
+    cl::Buffer bufferCoeff(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cfg.coeff.size() * sizeof(float), cfg.coeff.data());
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    const std::string kernelSource = readKernelFile(cfg.kernelPath); /* Read kernel */
+    const cl::NDRange globalSize((width + TILE_X - 1) / TILE_X * TILE_X, (height + TILE_Y - 1) / TILE_Y * TILE_Y);
+    const cl::NDRange localSize(TILE_X, TILE_Y);
+
+    bool allCorrect = true;
+    std::cout << std::left << std::setw(8) << "steps" << std::setw(10) << "launches" << std::setw(12) << "kernel ms"
+        << std::setw(12) << "wall ms" << std::setw(12) << "Mcells/s" << std::setw(12) << "work/cell" << "check\n";
+
+    for (unsigned int depth : cfg.depths) {
+        const size_t localBytes = 2 * sizeof(float) * (TILE_X + 2 * depth) * (TILE_Y + 2 * depth);
+        if (localBytes > localMem) {
+            std::cout << std::left << std::setw(8) << depth << "skipped: " << localBytes << " bytes of local memory\n";
+            continue;
+        }
+
+        std::string defines = "#define TILE_X " + std::to_string(TILE_X) + "\n";
+        defines += "#define TILE_Y " + std::to_string(TILE_Y) + "\n";
+        defines += "#define STEPS " + std::to_string(depth) + "\n";
+        defines += "#define POINTS " + std::to_string(cfg.Points) + "\n";
+        cl::Program program(context, defines + kernelSource);
+        program.build({ selectedDevice });
+        cl::Kernel kernel(program, "stencil");
+        kernel.setArg(2, width);
+        kernel.setArg(3, height);
+        kernel.setArg(4, bufferCoeff);
+
+        queue.enqueueCopyBuffer(bufferInit, bufferPing, 0, 0, cells * sizeof(float));
+        queue.finish();
+
+        // every launch writes the whole grid, boundary included: the buffers just swap roles
+        std::vector<cl::Event> events;
+        cl::Buffer* src = &bufferPing;
+        cl::Buffer* dst = &bufferPong;
+        auto gpuWallStart = std::chrono::high_resolution_clock::now();
+        for (unsigned int done = 0; done < cfg.Iters; done += depth) {
+            kernel.setArg(0, *src);
+            kernel.setArg(1, *dst);
+            kernel.setArg(5, std::min(depth, cfg.Iters - done));
+            events.emplace_back();
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize, nullptr, &events.back());
+            std::swap(src, dst);
+        }
+        queue.finish();
+        auto gpuWallEnd = std::chrono::high_resolution_clock::now();
+        double gpuWallMs = std::chrono::duration<double, std::milli>(gpuWallEnd - gpuWallStart).count();
+
+        cl_ulong kernelNs = 0;
+        for (const auto& e : events) kernelNs += elapsedNs(e);
+
+        queue.enqueueReadBuffer(*src, CL_TRUE, 0, cells * sizeof(float), hostGrid.data());
+        bool correct = true;
+        for (size_t i = 0; i < cells && correct; ++i) {
+            correct = std::abs(hostGrid[i] - hostRef[i]) <= 1e-4f;
+        }
+        allCorrect = allCorrect && correct;
+
+        // sweeps computed per tile over sweeps that land in the output: the halo work of temporal blocking
+        double computed = 0.0;
+        for (unsigned int s = 1; s <= depth; ++s) {
+            computed += static_cast<double>(TILE_X + 2 * (depth - s)) * (TILE_Y + 2 * (depth - s));
+        }
+        const double redundant = computed / (static_cast<double>(depth) * TILE_X * TILE_Y);
+
+        const double updates = static_cast<double>(cells) * cfg.Iters;
+        std::cout << std::left << std::setw(8) << depth << std::setw(10) << events.size()
+            << std::setw(12) << kernelNs * 1e-6 << std::setw(12) << gpuWallMs
+            << std::setw(12) << updates / (kernelNs * 1e-3)
+            << std::setw(12) << redundant << (correct ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\nCPU time:         " << cpuTimeMs << " ms (" << cells * static_cast<double>(cfg.Iters) / (cpuTimeMs * 1e3)
+        << " Mcells/s)\n";
+    std::cout << "\nResult correctness: " << (allCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Stencil iterations completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* stencil OpenCL kernel
+*
+* Jacobi sweeps of a 3 x 3 stencil on a width x height grid; the outer ring of cells is a fixed boundary.
+* Every work-group owns a TILE_X x TILE_Y output tile and loads it with a halo of STEPS cells into local
+* memory, then runs up to STEPS sweeps there (temporal blocking): after sweep s only cells at least s away
+* from the local edge are still exact, and after all sweeps that is the output tile.
+* Coefficients are row-major: coeff[0] NW, coeff[1] N, coeff[2] NE, ..., coeff[4] centre, ..., coeff[8] SE.
+* POINTS 5 skips the corner terms.
+*/
+
+/* #define TILE_X 32 */   /*for ocloc offline compilation*/
+/* #define TILE_Y 8 */
+/* #define STEPS 4 */
+/* #define POINTS 9 */
+
+#define LW (TILE_X + 2 * STEPS)
+#define LH (TILE_Y + 2 * STEPS)
+
+__kernel void stencil(__global const float* in,
+                      __global float* out,
+                      uint width,
+                      uint height,
+                      __constant float* coeff,
+                      uint steps) {
+    __local float bufA[LW * LH];
+    __local float bufB[LW * LH];
+
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    // global coordinates of local cell (0, 0)
+    const int x0 = (int)(get_group_id(0) * TILE_X) - STEPS;
+    const int y0 = (int)(get_group_id(1) * TILE_Y) - STEPS;
+
+    for (int ly = ty; ly < LH; ly += TILE_Y) {
+        for (int lx = tx; lx < LW; lx += TILE_X) {
+            const int gx = x0 + lx;
+            const int gy = y0 + ly;
+            bufA[ly * LW + lx] = (gx >= 0 && gx < (int)width && gy >= 0 && gy < (int)height) ? in[gy * width + gx] : 0.0f;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    __local float* src = bufA;
+    __local float* dst = bufB;
+    for (int s = 1; s <= (int)steps; ++s) {
+        // the exact region shrinks by one cell per sweep
+        for (int ly = s + ty; ly < LH - s; ly += TILE_Y) {
+            for (int lx = s + tx; lx < LW - s; lx += TILE_X) {
+                const int gx = x0 + lx;
+                const int gy = y0 + ly;
+                const int i = ly * LW + lx;
+                float v = src[i];
+                if (gx > 0 && gx < (int)width - 1 && gy > 0 && gy < (int)height - 1) {
+                    v = coeff[1] * src[i - LW] + coeff[3] * src[i - 1] + coeff[4] * src[i]
+                      + coeff[5] * src[i + 1] + coeff[7] * src[i + LW];
+#if POINTS == 9
+                    v += coeff[0] * src[i - LW - 1] + coeff[2] * src[i - LW + 1]
+                       + coeff[6] * src[i + LW - 1] + coeff[8] * src[i + LW + 1];
+#endif
+                }
+                dst[i] = v;
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        __local float* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    const int gx = x0 + STEPS + tx;
+    const int gy = y0 + STEPS + ty;
+    if (gx < (int)width && gy < (int)height) {
+        out[gy * width + gx] = src[(ty + STEPS) * LW + tx + STEPS];
+    }
+}
\ No newline at end of file
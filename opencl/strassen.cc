@@ -0,0 +1,456 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for Strassen-Winograd matrix multiplication: the host recursion splits the
+* matrices into quadrants down to a cutoff size and replaces 8 quadrant products by 7 products and
+* 15 quadrant additions. The leaf products run on the tiled matrixmult kernel from matrix_localmem.cl,
+* the additions on the matadd kernel, and every temporary comes from a workspace allocated once up
+* front. Each recursion depth is compared with the classic tiled product (depth 0).
+*
+* ICPX:    icpx strassen.cc -o strassen.exe -O2 -std=c++20 -lOpenCL
+* Usage:   strassen.exe -size=4096 -cutoff=512 -tile=16 (as a sample)
+*          strassen.exe -size=3000 -depth=2
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <array>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 4096;
+    unsigned int cutoff = 512;  // recurse while the quadrants are at least this large
+    unsigned int depth = 0;     // deepest recursion level to run, 0 = derived from cutoff
+    unsigned int Tile = 16;
+    unsigned int samples = 64;  // entries of the classic product checked on the CPU
+    std::string kernelPath = "strassen.cl";
+    std::string gemmPath = "matrix_localmem.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-cutoff=")) {
+            auto res = std::from_chars(arg.data() + 8, arg.data() + arg.size(), cfg.cutoff);
+            if (res.ec != std::errc{} || cfg.cutoff == 0) {
+                std::cerr << "Invalid -cutoff value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-depth=")) {
+            auto res = std::from_chars(arg.data() + 7, arg.data() + arg.size(), cfg.depth);
+            if (res.ec != std::errc{} || cfg.depth > 10) {
+                std::cerr << "Invalid -depth value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-tile=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Tile);
+            if (res.ec != std::errc{} || cfg.Tile == 0) {
+                std::cerr << "Invalid -tile value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// STRASSEN-WINOGRAD
+
+// n x n view of a device matrix: element (i, j) lives at offset + i * ld + j
+struct View {
+    const cl::Buffer* buf;
+    unsigned int offset;
+    unsigned int ld;
+
+    View quad(unsigned int qi, unsigned int qj, unsigned int h) const {
+        return { buf, offset + qi * h * ld + qj * h, ld };
+    }
+};
+
+// Level l of the recursion works on (size >> l) matrices and needs 15 quadrant-sized temporaries;
+// the seven sub-products run one after another, so a level's temporaries are shared by all of them.
+// Leaf operands that are quadrants of a larger matrix are copied to contiguous leaf buffers first,
+// because matrixmult expects a dense N x N matrix.
+struct Workspace {
+    enum { S1, S2, S3, S4, T1, T2, T3, T4, P1, P2, P3, P4, P5, P6, P7, Count };
+    std::vector<std::array<cl::Buffer, Count>> levels;
+    cl::Buffer leafA, leafB, leafC;
+    size_t bytes = 0;
+
+    Workspace(const cl::Context& context, unsigned int size, unsigned int maxDepth) {
+        for (unsigned int l = 0; l < maxDepth; ++l) {
+            const size_t h = size >> (l + 1);
+            const size_t quadBytes = h * h * sizeof(float);
+            std::array<cl::Buffer, Count> level;
+            for (auto& buffer : level) buffer = cl::Buffer(context, CL_MEM_READ_WRITE, quadBytes);
+            levels.push_back(level);
+            bytes += Count * quadBytes;
+        }
+        if (maxDepth > 0) {
+            const size_t leaf = size >> 1;  // the largest leaf: depth 1
+            const size_t leafBytes = leaf * leaf * sizeof(float);
+            leafA = cl::Buffer(context, CL_MEM_READ_WRITE, leafBytes);
+            leafB = cl::Buffer(context, CL_MEM_READ_WRITE, leafBytes);
+            leafC = cl::Buffer(context, CL_MEM_READ_WRITE, leafBytes);
+            bytes += 3 * leafBytes;
+        }
+    }
+};
+
+class Strassen {
+public:
+    Strassen(cl::CommandQueue& queue, const cl::Program& program, const cl::Program& gemmProgram,
+        Workspace& ws, unsigned int tile)
+        : queue(queue), addKernel(program, "matadd"), gemmKernel(gemmProgram, "matrixmult"), ws(ws), tile(tile) {}
+
+    // C = A * B for size x size views, recursing depth times
+    void run(View A, View B, View C, unsigned int size, unsigned int depth) {
+        maxLevel = depth;
+        gemmEvents.clear();
+        addEvents.clear();
+        multiply(A, B, C, size, 0);
+    }
+
+    cl_ulong gemmNs() const { return sum(gemmEvents); }
+    cl_ulong addNs() const { return sum(addEvents); }
+    size_t launches() const { return gemmEvents.size() + addEvents.size(); }
+
+private:
+    cl::CommandQueue& queue;
+    cl::Kernel addKernel;
+    cl::Kernel gemmKernel;
+    Workspace& ws;
+    unsigned int tile;
+    unsigned int maxLevel = 0;
+    std::vector<cl::Event> gemmEvents;
+    std::vector<cl::Event> addEvents;
+
+    static cl_ulong sum(const std::vector<cl::Event>& events) {
+        cl_ulong ns = 0;
+        for (const auto& e : events) ns += elapsedNs(e);
+        return ns;
+    }
+
+    // C = A + beta * B
+    void add(View C, View A, View B, float beta, unsigned int n) {
+        addKernel.setArg(0, *C.buf);
+        addKernel.setArg(1, C.offset);
+        addKernel.setArg(2, C.ld);
+        addKernel.setArg(3, *A.buf);
+        addKernel.setArg(4, A.offset);
+        addKernel.setArg(5, A.ld);
+        addKernel.setArg(6, *B.buf);
+        addKernel.setArg(7, B.offset);
+        addKernel.setArg(8, B.ld);
+        addKernel.setArg(9, beta);
+        addKernel.setArg(10, n);
+
+        const cl::NDRange global(roundUp(n, 16), roundUp(n, 16));
+        addEvents.emplace_back();
+        queue.enqueueNDRangeKernel(addKernel, cl::NullRange, global, cl::NDRange(16, 16), nullptr, &addEvents.back());
+    }
+
+    void leaf(View A, View B, View C, unsigned int n) {
+        auto dense = [n](const View& v) { return v.offset == 0 && v.ld == n; };
+        const View a = dense(A) ? A : View{ &ws.leafA, 0, n };
+        const View b = dense(B) ? B : View{ &ws.leafB, 0, n };
+        const View c = dense(C) ? C : View{ &ws.leafC, 0, n };
+        if (!dense(A)) add(a, A, A, 0.0f, n);
+        if (!dense(B)) add(b, B, B, 0.0f, n);
+
+        gemmKernel.setArg(0, *a.buf);
+        gemmKernel.setArg(1, *b.buf);
+        gemmKernel.setArg(2, *c.buf);
+        gemmKernel.setArg(3, n);
+
+        const cl::NDRange global(roundUp(n, tile), roundUp(n, tile));
+        gemmEvents.emplace_back();
+        queue.enqueueNDRangeKernel(gemmKernel, cl::NullRange, global, cl::NDRange(tile, tile), nullptr, &gemmEvents.back());
+
+        if (!dense(C)) add(C, c, c, 0.0f, n);
+    }
+
+    void multiply(View A, View B, View C, unsigned int n, unsigned int level) {
+        if (level == maxLevel) {
+            leaf(A, B, C, n);
+            return;
+        }
+
+        const unsigned int h = n / 2;
+        auto& t = ws.levels[level];
+        auto tmp = [&](int i) { return View{ &t[i], 0, h }; };
+
+        const View A11 = A.quad(0, 0, h), A12 = A.quad(0, 1, h), A21 = A.quad(1, 0, h), A22 = A.quad(1, 1, h);
+        const View B11 = B.quad(0, 0, h), B12 = B.quad(0, 1, h), B21 = B.quad(1, 0, h), B22 = B.quad(1, 1, h);
+        const View C11 = C.quad(0, 0, h), C12 = C.quad(0, 1, h), C21 = C.quad(1, 0, h), C22 = C.quad(1, 1, h);
+        const View S1 = tmp(Workspace::S1), S2 = tmp(Workspace::S2), S3 = tmp(Workspace::S3), S4 = tmp(Workspace::S4);
+        const View T1 = tmp(Workspace::T1), T2 = tmp(Workspace::T2), T3 = tmp(Workspace::T3), T4 = tmp(Workspace::T4);
+        const View P1 = tmp(Workspace::P1), P2 = tmp(Workspace::P2), P3 = tmp(Workspace::P3), P4 = tmp(Workspace::P4);
+        const View P5 = tmp(Workspace::P5), P6 = tmp(Workspace::P6), P7 = tmp(Workspace::P7);
+
+        // 8 pre-additions
+        add(S1, A21, A22, 1.0f, h);
+        add(S2, S1, A11, -1.0f, h);
+        add(S3, A11, A21, -1.0f, h);
+        add(S4, A12, S2, -1.0f, h);
+        add(T1, B12, B11, -1.0f, h);
+        add(T2, B22, T1, -1.0f, h);
+        add(T3, B22, B12, -1.0f, h);
+        add(T4, T2, B21, -1.0f, h);
+
+        // 7 products
+        multiply(A11, B11, P1, h, level + 1);
+        multiply(A12, B21, P2, h, level + 1);
+        multiply(S4, B22, P3, h, level + 1);
+        multiply(A22, T4, P4, h, level + 1);
+        multiply(S1, T1, P5, h, level + 1);
+        multiply(S2, T2, P6, h, level + 1);
+        multiply(S3, T3, P7, h, level + 1);
+
+        // 7 post-additions, U2..U4 accumulated in place in P6 and P7
+        add(C11, P1, P2, 1.0f, h);   // U1
+        add(P6, P1, P6, 1.0f, h);    // U2 = P1 + P6
+        add(P7, P6, P7, 1.0f, h);    // U3 = U2 + P7
+        add(P6, P6, P5, 1.0f, h);    // U4 = U2 + P5
+        add(C12, P6, P3, 1.0f, h);   // U5 = U4 + P3
+        add(C21, P7, P4, -1.0f, h);  // U6 = U3 - P4
+        add(C22, P7, P5, 1.0f, h);   // U7 = U3 + P5
+    }
+};
+
+// CPU matrix
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Single entry of A * B in double; ld is the padded row length
+double entry_ref(const std::vector<float>& A, const std::vector<float>& B, unsigned int N, unsigned int ld,
+    unsigned int i, unsigned int j) {
+    double sum = 0.0;
+    for (unsigned int k = 0; k < N; ++k)
+        sum += static_cast<double>(A[static_cast<size_t>(i) * ld + k]) * B[static_cast<size_t>(k) * ld + j];
+    return sum;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+
+    unsigned int maxDepth = cfg.depth;
+    if (maxDepth == 0) {
+        while ((N >> (maxDepth + 1)) >= cfg.cutoff) ++maxDepth;
+    }
+    if ((N >> maxDepth) == 0) {
+        std::cerr << "Invalid -depth value\n";
+        return EXIT_FAILURE;
+    }
+    // every level halves the matrix: pad with zeros to a multiple of 2^maxDepth
+    const unsigned int size = static_cast<unsigned int>(roundUp(N, size_t{ 1 } << maxDepth));
+    const size_t elements = static_cast<size_t>(size) * size;
+
+    std::cout << "Matrix size: " << N << " x " << N << " (padded to " << size << ")\n";
+    std::cout << "Cutoff: " << cfg.cutoff << ", depths 0.." << maxDepth << ", tile size: " << cfg.Tile << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << " + " << cfg.gemmPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    cl::Program program(context, readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice });
+    const std::string defines = "#define TILE " + std::to_string(cfg.Tile) + "\n";
+    cl::Program gemmProgram(context, defines + readKernelFile(cfg.gemmPath));
+    gemmProgram.build({ selectedDevice });
+
+    std::vector<float> hostA(elements, 0.0f);
+    std::vector<float> hostB(elements, 0.0f);
+    {
+        std::vector<float> row(N);
+        for (unsigned int i = 0; i < N; ++i) {
+            rand_init(row, -1.0f, 1.0f);
+            std::copy(row.begin(), row.end(), hostA.begin() + static_cast<size_t>(i) * size);
+            rand_init(row, -1.0f, 1.0f);
+            std::copy(row.begin(), row.end(), hostB.begin() + static_cast<size_t>(i) * size);
+        }
+    }
+
+    cl::Buffer bufferA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostA.data());
+    cl::Buffer bufferB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostB.data());
+    cl::Buffer bufferC(context, CL_MEM_READ_WRITE, elements * sizeof(float));
+
+    Workspace ws(context, size, maxDepth);
+    std::cout << "Workspace: " << ws.bytes / (1024.0 * 1024.0) << " MB\n\n";
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+    Strassen strassen(queue, program, gemmProgram, ws, cfg.Tile);
+
+    const View A{ &bufferA, 0, size };
+    const View B{ &bufferB, 0, size };
+    const View C{ &bufferC, 0, size };
+    const double flops = 2.0 * N * N * static_cast<double>(N); // classic count: the reference rate
+
+    std::vector<float> classic(elements);
+    std::vector<float> result(elements);
+    double classicMs = 0.0;
+    double classicMax = 0.0;
+    bool correct = true;
+
+    std::cout << std::left << std::setw(7) << "depth" << std::setw(8) << "leaf" << std::setw(10) << "launches"
+        << std::setw(11) << "gemm ms" << std::setw(11) << "add ms" << std::setw(11) << "wall ms" << std::setw(10) << "GFLOPS"
+        << std::setw(10) << "speedup" << std::setw(12) << "max error" << "rel error\n";
+
+    for (unsigned int depth = 0; depth <= maxDepth; ++depth) {
+        strassen.run(A, B, C, size, depth); // warm-up
+        queue.finish();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        strassen.run(A, B, C, size, depth);
+        queue.finish();
+        auto end = std::chrono::high_resolution_clock::now();
+        const double wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, elements * sizeof(float), depth == 0 ? classic.data() : result.data());
+
+        double maxError = 0.0;
+        if (depth == 0) {
+            classicMs = wallMs;
+            for (unsigned int i = 0; i < N; ++i)
+                for (unsigned int j = 0; j < N; ++j)
+                    classicMax = std::max(classicMax, static_cast<double>(std::abs(classic[static_cast<size_t>(i) * size + j])));
+
+            // spot-check the classic product itself on the CPU
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<unsigned int> pick(0, N - 1);
+            for (unsigned int s = 0; s < cfg.samples; ++s) {
+                const unsigned int i = pick(gen), j = pick(gen);
+                const double ref = entry_ref(hostA, hostB, N, size, i, j);
+                if (std::abs(classic[static_cast<size_t>(i) * size + j] - ref) > 1e-3 * std::abs(ref) + 1e-3) correct = false;
+            }
+        }
+        else {
+            for (unsigned int i = 0; i < N; ++i)
+                for (unsigned int j = 0; j < N; ++j) {
+                    const size_t idx = static_cast<size_t>(i) * size + j;
+                    maxError = std::max(maxError, static_cast<double>(std::abs(result[idx] - classic[idx])));
+                }
+        }
+        const double relError = classicMax > 0.0 ? maxError / classicMax : 0.0;
+        if (relError > 1e-3) correct = false;
+
+        std::cout << std::left << std::setw(7) << depth << std::setw(8) << (size >> depth) << std::setw(10) << strassen.launches()
+            << std::setw(11) << strassen.gemmNs() * 1e-6 << std::setw(11) << strassen.addNs() * 1e-6 << std::setw(11) << wallMs
+            << std::setw(10) << flops / (wallMs * 1e6) << std::setw(10) << classicMs / wallMs << std::setw(12) << maxError
+            << relError << "\n";
+    }
+
+    std::cout << "\nErrors are against the classic product (depth 0), relative to max |C| = " << classicMax << "\n";
+    std::cout << "\nResult correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Strassen-Winograd multiplication completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* strassen OpenCL kernel
+*
+* Sub-matrix additions for the Strassen-Winograd recursion in strassen.cc; the products themselves
+* run on matrixmult from matrix_localmem.cl.
+*   matadd - C = A + beta * B on n x n views: every view is (buffer, offset, leading dimension), so
+*            quadrants are used in place; beta = -1 subtracts, beta = 0 copies A
+* C may alias A or B: every element is read and written by the same work-item.
+*/
+
+__kernel void matadd(__global float* C, uint offC, uint ldc,
+                     __global const float* A, uint offA, uint lda,
+                     __global const float* B, uint offB, uint ldb,
+                     float beta,
+                     uint n) {
+    const uint col = get_global_id(0);
+    const uint row = get_global_id(1);
+    if (row < n && col < n) {
+        C[offC + row * ldc + col] = A[offA + row * lda + col] + beta * B[offB + row * ldb + col];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for Stream-K matrix multiplication: instead of one work-group per C tile,
+* a persistent grid of exactly compute units x occupancy work-groups shares the MAC iterations
+* (tiles x K steps) evenly, splitting tiles along K where a share ends mid-tile, and a fix-up pass
+* adds up the split tiles. Compared with the one-group-per-tile kernel from matrix_localmem.cl over
+* mid-size matrices, where the last wave of tiles leaves most compute units idle.
+*
+* ICPX:    icpx streamk.cc -o streamk.exe -O2 -std=c++20 -lOpenCL
+* Usage:   streamk.exe -tile=16 (as a sample: sweeps N = 512..1536)
+*          streamk.exe -size=1000 -occupancy=2
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 0;         // 0 = sweep 512..1536
+    unsigned int Tile = 16;
+    unsigned int occupancy = 0; // work-groups per compute unit, 0 = from local memory
+    std::string kernelPath = "streamk.cl";
+    std::string densePath = "matrix_localmem.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-tile=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Tile);
+            if (res.ec != std::errc{} || cfg.Tile == 0) {
+                std::cerr << "Invalid -tile value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-occupancy=")) {
+            auto res = std::from_chars(arg.data() + 11, arg.data() + arg.size(), cfg.occupancy);
+            if (res.ec != std::errc{}) {
+                std::cerr << "Invalid -occupancy value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// CPU matrix
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+bool nearlyEqual(const std::vector<float>& a, const std::vector<float>& b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i] - b[i]) > 1e-3f * std::abs(b[i]) + 1e-3f) return false;
+    }
+    return true;
+}
+
+// Single entry of A * B in double
+double entry_ref(const std::vector<float>& A, const std::vector<float>& B, unsigned int N,
+    unsigned int i, unsigned int j) {
+    double sum = 0.0;
+    for (unsigned int k = 0; k < N; ++k)
+        sum += static_cast<double>(A[static_cast<size_t>(i) * N + k]) * B[static_cast<size_t>(k) * N + j];
+    return sum;
+}
+
+constexpr unsigned int SAMPLES = 64;   // entries of the Stream-K product checked on the CPU
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int tile = cfg.Tile;
+
+    std::vector<unsigned int> sizes;
+    if (cfg.N != 0) sizes.push_back(cfg.N);
+    else for (unsigned int n = 512; n <= 1536; n += 128) sizes.push_back(n);
+
+    std::cout << "Tile size: " << tile << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << " vs " << cfg.densePath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n";
+
+    // occupancy: as many TILE x TILE groups per compute unit as local memory holds, at most 4
+    const size_t computeUnits = selectedDevice.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t localMem = selectedDevice.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    const size_t groupLocalBytes = 2 * static_cast<size_t>(tile) * tile * sizeof(float);
+    const size_t occupancy = cfg.occupancy != 0 ? cfg.occupancy : std::clamp<size_t>(localMem / groupLocalBytes, 1, 4);
+    const size_t persistentGroups = computeUnits * occupancy;
+    std::cout << "Compute units: " << computeUnits << ", occupancy: " << occupancy << ", persistent groups: "
+        << persistentGroups << "\n\n";
+
+    const std::string defines = "#define TILE " + std::to_string(tile) + "\n";
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice });
+    cl::Program denseProgram(context, defines + readKernelFile(cfg.densePath));
+    denseProgram.build({ selectedDevice });
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+    cl::Kernel denseKernel(denseProgram, "matrixmult");
+    cl::Kernel streamKernel(program, "matrixmult_streamk");
+    cl::Kernel fixupKernel(program, "streamk_fixup");
+
+    // two partial tiles per group at most: the first and the last tile of its share
+    cl::Buffer bufferPartials(context, CL_MEM_READ_WRITE, 2 * persistentGroups * tile * tile * sizeof(float));
+
+    bool correct = true;
+
+    std::cout << std::left << std::setw(7) << "N" << std::setw(8) << "tiles" << std::setw(8) << "waves" << std::setw(11) << "last wave"
+        << std::setw(12) << "tiled ms" << std::setw(13) << "stream-k ms" << std::setw(11) << "fixup ms" << std::setw(10) << "GFLOPS"
+        << std::setw(10) << "speedup" << "check\n";
+
+    for (unsigned int N : sizes) {
+        const size_t elements = static_cast<size_t>(N) * N;
+        const unsigned int tilesN = (N + tile - 1) / tile;
+        const unsigned int iters = tilesN;   // K steps per tile: K = N
+        const size_t tiles = static_cast<size_t>(tilesN) * tilesN;
+        const size_t groups = std::min(persistentGroups, tiles * iters); // every group gets an iteration
+
+        std::vector<float> hostA(elements);
+        std::vector<float> hostB(elements);
+        std::vector<float> hostC_tiled(elements);
+        std::vector<float> hostC_stream(elements);
+        rand_init(hostA, -1.0f, 1.0f);
+        rand_init(hostB, -1.0f, 1.0f);
+
+        cl::Buffer bufferA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostA.data());
+        cl::Buffer bufferB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, elements * sizeof(float), hostB.data());
+        cl::Buffer bufferC(context, CL_MEM_READ_WRITE, elements * sizeof(float));
+
+        const cl::NDRange localSize(tile, tile);
+
+        // One group per tile
+        denseKernel.setArg(0, bufferA);
+        denseKernel.setArg(1, bufferB);
+        denseKernel.setArg(2, bufferC);
+        denseKernel.setArg(3, N);
+
+        const cl::NDRange denseGlobal(static_cast<size_t>(tilesN) * tile, static_cast<size_t>(tilesN) * tile);
+        cl::Event denseEvent;
+        queue.enqueueNDRangeKernel(denseKernel, cl::NullRange, denseGlobal, localSize); // warm-up
+        queue.enqueueNDRangeKernel(denseKernel, cl::NullRange, denseGlobal, localSize, nullptr, &denseEvent);
+        queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, elements * sizeof(float), hostC_tiled.data());
+
+        // Stream-K: persistent grid, then the fix-up over the same grid
+        streamKernel.setArg(0, bufferA);
+        streamKernel.setArg(1, bufferB);
+        streamKernel.setArg(2, bufferC);
+        streamKernel.setArg(3, bufferPartials);
+        streamKernel.setArg(4, N);
+        streamKernel.setArg(5, tilesN);
+        streamKernel.setArg(6, iters);
+
+        fixupKernel.setArg(0, bufferPartials);
+        fixupKernel.setArg(1, bufferC);
+        fixupKernel.setArg(2, N);
+        fixupKernel.setArg(3, tilesN);
+        fixupKernel.setArg(4, iters);
+
+        const cl::NDRange streamGlobal(groups * tile, tile);
+        queue.enqueueFillBuffer(bufferC, 0.0f, 0, elements * sizeof(float));
+        queue.enqueueNDRangeKernel(streamKernel, cl::NullRange, streamGlobal, localSize); // warm-up
+        cl::Event streamEvent, fixupEvent;
+        queue.enqueueNDRangeKernel(streamKernel, cl::NullRange, streamGlobal, localSize, nullptr, &streamEvent);
+        queue.enqueueNDRangeKernel(fixupKernel, cl::NullRange, streamGlobal, localSize, nullptr, &fixupEvent);
+        queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, elements * sizeof(float), hostC_stream.data());
+
+        bool ok = nearlyEqual(hostC_stream, hostC_tiled);
+
+        // spot-check against the CPU as well, so a fault shared with the tiled kernel shows up
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<unsigned int> pick(0, N - 1);
+        for (unsigned int s = 0; s < SAMPLES; ++s) {
+            const unsigned int i = pick(gen), j = pick(gen);
+            const double ref = entry_ref(hostA, hostB, N, i, j);
+            if (std::abs(hostC_stream[static_cast<size_t>(i) * N + j] - ref) > 1e-3 * std::abs(ref) + 1e-3) ok = false;
+        }
+        correct = correct && ok;
+
+        const cl_ulong denseNs = elapsedNs(denseEvent);
+        const cl_ulong streamNs = elapsedNs(streamEvent) + elapsedNs(fixupEvent);
+        const double flops = 2.0 * N * N * static_cast<double>(N);
+        const size_t lastWave = tiles % persistentGroups == 0 ? persistentGroups : tiles % persistentGroups;
+
+        std::cout << std::left << std::setw(7) << N << std::setw(8) << tiles
+            << std::setw(8) << std::setprecision(3) << static_cast<double>(tiles) / persistentGroups
+            << std::setw(11) << std::to_string(100 * lastWave / persistentGroups) + "%"
+            << std::setprecision(6) << std::setw(12) << denseNs * 1e-6 << std::setw(13) << streamNs * 1e-6
+            << std::setw(11) << elapsedNs(fixupEvent) * 1e-6 << std::setw(10) << flops / streamNs
+            << std::setw(10) << static_cast<double>(denseNs) / streamNs << (ok ? "PASSED" : "FAILED") << "\n";
+    }
+
+    std::cout << "\nwaves = tiles / persistent groups; last wave = share of the group slots the tiled kernel fills in its last wave\n";
+    std::cout << "\nResult correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Stream-K matrix multiplication completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
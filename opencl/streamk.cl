@@ -0,0 +1,117 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* streamk OpenCL kernels
+*
+* Stream-K GEMM C = A * B, N x N row-major, TILE x TILE tiles of C. The work is counted in MAC
+* iterations, one per TILE-wide step along K of one C tile: tiles * iters in total. A persistent grid
+* of work-groups splits that range evenly, so every group does the same work whatever the tile count:
+*   matrixmult_streamk - group g walks iterations [g * total / groups, (g + 1) * total / groups);
+*                        a tile covered completely is written to C, a piece of a tile split along K
+*                        goes to a partial slot: 2g for the group's first tile, 2g + 1 for its last
+*   streamk_fixup      - the same grid: the group that starts a split tile adds up the partials of
+*                        every group that worked on it and writes the C tile
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+
+inline ulong iter_begin(uint g, uint groups, ulong total) {
+    return (ulong)g * total / groups;
+}
+
+__kernel void matrixmult_streamk(__global const float* A,
+                                 __global const float* B,
+                                 __global float* C,
+                                 __global float* partials,
+                                 const unsigned int N,
+                                 const unsigned int tilesN,
+                                 const unsigned int iters)
+{
+    __local float Asub[TILE][TILE];
+    __local float Bsub[TILE][TILE];
+
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+    const uint g = get_group_id(0);
+    const uint groups = get_num_groups(0);
+    const ulong total = (ulong)tilesN * tilesN * iters;
+
+    ulong it = iter_begin(g, groups, total);
+    const ulong end = iter_begin(g + 1, groups, total);
+    const uint firstTile = it / iters;
+
+    // the bounds are uniform across the group: every work-item reaches every barrier
+    while (it < end) {
+        const uint tile = it / iters;
+        const uint kBegin = it % iters;
+        const uint kEnd = (uint)min((ulong)iters, kBegin + (end - it));
+
+        const int row = (tile / tilesN) * TILE + ty;
+        const int col = (tile % tilesN) * TILE + tx;
+
+        float sum = 0.0f;
+        for (uint t = kBegin; t < kEnd; ++t) {
+            const int k = t * TILE;
+
+            Asub[ty][tx] = (row < N && (k + tx) < N) ? A[row * N + (k + tx)] : 0.0f;
+            Bsub[ty][tx] = ((k + ty) < N && col < N) ? B[(k + ty) * N + col] : 0.0f;
+
+            // SYNC
+            barrier(CLK_LOCAL_MEM_FENCE);
+
+            for (int k_local = 0; k_local < TILE; ++k_local) {
+                sum += Asub[ty][k_local] * Bsub[k_local][tx];
+            }
+
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (kBegin == 0 && kEnd == iters) {
+            if (row < N && col < N) {
+                C[row * N + col] = sum;
+            }
+        } else {
+            const uint slot = 2 * g + (tile == firstTile ? 0 : 1);
+            partials[(slot * TILE + ty) * TILE + tx] = sum;
+        }
+
+        it += kEnd - kBegin;
+    }
+}
+
+__kernel void streamk_fixup(__global const float* partials,
+                            __global float* C,
+                            const unsigned int N,
+                            const unsigned int tilesN,
+                            const unsigned int iters)
+{
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+    const uint g = get_group_id(0);
+    const uint groups = get_num_groups(0);
+    const ulong total = (ulong)tilesN * tilesN * iters;
+
+    const ulong begin = iter_begin(g, groups, total);
+    const ulong end = iter_begin(g + 1, groups, total);
+
+    // the tile of the group's last iteration is ours if it starts here and continues past us
+    const uint tile = (end - 1) / iters;
+    const ulong tileBegin = (ulong)tile * iters;
+    const ulong tileEnd = tileBegin + iters;
+    if (tileBegin < begin || tileEnd <= end) return;
+
+    float sum = 0.0f;
+    for (uint gg = g; gg < groups; ++gg) {
+        const ulong first = iter_begin(gg, groups, total);
+        if (first >= tileEnd) break;
+        const uint slot = 2 * gg + (first / iters == tile ? 0 : 1);
+        sum += partials[(slot * TILE + ty) * TILE + tx];
+    }
+
+    const int row = (tile / tilesN) * TILE + ty;
+    const int col = (tile % tilesN) * TILE + tx;
+    if (row < N && col < N) {
+        C[row * N + col] = sum;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* An OpenCL application for the symmetric rank-k update C = A * A^T (Gram matrix) that computes only
+* the tiles on and above the diagonal, with an optional mirror pass for the lower triangle.
+* Compared with the same tiled product over every tile of C.
+*
+* ICPX:    icpx syrk.cc -o syrk.exe -O2 -std=c++20 -lOpenCL
+* Usage:   syrk.exe -size=1024 -k=1024 -tile=16 (as a sample)
+*          syrk.exe -size=2048 -k=512 -nomirror
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <algorithm>
+#include <cmath>
+
+#include <cstdlib>
+
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+
+#include <CL/opencl.hpp>
+
+// HELPERS&CONFIG
+
+struct Config {
+    unsigned int N = 1024;      // rows of A, C is N x N
+    unsigned int K = 1024;      // columns of A
+    unsigned int Tile = 16;
+    bool mirror = true;         // fill the lower triangle of C too
+    std::string kernelPath = "syrk.cl";
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-k=")) {
+            auto res = std::from_chars(arg.data() + 3, arg.data() + arg.size(), cfg.K);
+            if (res.ec != std::errc{} || cfg.K == 0) {
+                std::cerr << "Invalid -k value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-tile=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.Tile);
+            if (res.ec != std::errc{} || cfg.Tile == 0) {
+                std::cerr << "Invalid -tile value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-nomirror") {
+            cfg.mirror = false;
+        }
+        else if (arg.starts_with("-kernel=")) {
+            cfg.kernelPath = std::string(arg.substr(8));
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+std::string readKernelFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open kernel file: " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// CPU matrix
+
+void rand_init(std::vector<float>& v, float low, float high) {
+    static std::mt19937_64 gen;
+    std::uniform_real_distribution<float> dist(low, high);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Upper triangle in double, mirrored: both rows of A are contiguous in the inner loop
+void syrk_ref(const float* A, float* C, unsigned int N, unsigned int K) {
+    for (unsigned int i = 0; i < N; ++i) {
+        for (unsigned int j = i; j < N; ++j) {
+            double sum = 0.0;
+            for (unsigned int k = 0; k < K; ++k)
+                sum += static_cast<double>(A[static_cast<size_t>(i) * K + k]) * A[static_cast<size_t>(j) * K + k];
+            C[static_cast<size_t>(i) * N + j] = static_cast<float>(sum);
+            C[static_cast<size_t>(j) * N + i] = static_cast<float>(sum);
+        }
+    }
+}
+
+// upper: compare only on and above the diagonal
+bool nearlyEqual(const std::vector<float>& gpu, const std::vector<float>& cpu, unsigned int N, bool upper) {
+    for (unsigned int i = 0; i < N; ++i) {
+        for (unsigned int j = upper ? i : 0; j < N; ++j) {
+            const size_t idx = static_cast<size_t>(i) * N + j;
+            if (std::abs(gpu[idx] - cpu[idx]) > 1e-3f * std::abs(cpu[idx]) + 1e-3f) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) try {
+    Config cfg = parseArgs(argc, argv);
+    const unsigned int N = cfg.N;
+    const unsigned int K = cfg.K;
+    const size_t sizeA = static_cast<size_t>(N) * K;
+    const size_t sizeC = static_cast<size_t>(N) * N;
+
+    std::cout << "A: " << N << " x " << K << ", C = A * A^T: " << N << " x " << N << "\n";
+    std::cout << "Tile size: " << cfg.Tile << (cfg.mirror ? ", lower triangle mirrored" : ", upper triangle only") << "\n";
+    std::cout << "Kernel file: " << cfg.kernelPath << "\n\n";
+
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    if (platforms.empty()) {
+        std::cerr << "No OpenCL platform found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Device selectedDevice;
+    bool found = false;
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        }
+        catch (const cl::Error& e) {
+            if (e.err() == CL_DEVICE_NOT_FOUND) continue;
+            throw;
+        }
+        for (auto& device : devices) {
+            if (device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() > 0) {
+                selectedDevice = device;
+                found = true;
+                break;
+            }
+        }
+        if (found) break;
+    }
+    if (!found) {
+        std::cerr << "No suitable GPU device found.\n";
+        return EXIT_FAILURE;
+    }
+
+    cl::Context context(selectedDevice);
+    std::string deviceName = selectedDevice.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected GPU: " << deviceName << "\n\n";
+
+    const std::string defines = "#define TILE " + std::to_string(cfg.Tile) + "\n";
+    cl::Program program(context, defines + readKernelFile(cfg.kernelPath));
+    program.build({ selectedDevice });
+
+    std::vector<float> hostA(sizeA);
+    std::vector<float> hostC_gpu(sizeC);
+    std::vector<float> hostC_cpu(sizeC);
+    rand_init(hostA, -1.0f, 1.0f);
+
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    syrk_ref(hostA.data(), hostC_cpu.data(), N, K);
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    double cpuTimeMs = std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count();
+
+    cl::Buffer bufferA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeA * sizeof(float), hostA.data());
+    cl::Buffer bufferC(context, CL_MEM_READ_WRITE, sizeC * sizeof(float));
+
+    cl::CommandQueue queue(context, selectedDevice, cl::QueueProperties::Profiling);
+
+    const unsigned int tiles = (N + cfg.Tile - 1) / cfg.Tile;
+    const size_t tilePairs = static_cast<size_t>(tiles) * (tiles + 1) / 2;
+    const cl::NDRange localSize(cfg.Tile, cfg.Tile);
+    const cl::NDRange triangleGlobal(cfg.Tile, tilePairs * cfg.Tile);
+    const cl::NDRange fullGlobal(static_cast<size_t>(tiles) * cfg.Tile, static_cast<size_t>(tiles) * cfg.Tile);
+
+    // Full product: every tile of C
+    cl::Kernel fullKernel(program, "syrk_full");
+    fullKernel.setArg(0, bufferA);
+    fullKernel.setArg(1, bufferC);
+    fullKernel.setArg(2, N);
+    fullKernel.setArg(3, K);
+
+    cl::Event fullEvent;
+    queue.enqueueNDRangeKernel(fullKernel, cl::NullRange, fullGlobal, localSize, nullptr, &fullEvent);
+    queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, sizeC * sizeof(float), hostC_gpu.data());
+    const bool fullCorrect = nearlyEqual(hostC_gpu, hostC_cpu, N, false);
+
+    // SYRK: upper tiles, then the mirror; C is cleared so the check sees only what SYRK wrote
+    cl::Kernel syrkKernel(program, "syrk");
+    syrkKernel.setArg(0, bufferA);
+    syrkKernel.setArg(1, bufferC);
+    syrkKernel.setArg(2, N);
+    syrkKernel.setArg(3, K);
+
+    cl::Kernel mirrorKernel(program, "syrk_mirror");
+    mirrorKernel.setArg(0, bufferC);
+    mirrorKernel.setArg(1, N);
+
+    queue.enqueueFillBuffer(bufferC, 0.0f, 0, sizeC * sizeof(float));
+    cl::Event syrkEvent, mirrorEvent;
+    queue.enqueueNDRangeKernel(syrkKernel, cl::NullRange, triangleGlobal, localSize, nullptr, &syrkEvent);
+    if (cfg.mirror) {
+        queue.enqueueNDRangeKernel(mirrorKernel, cl::NullRange, triangleGlobal, localSize, nullptr, &mirrorEvent);
+    }
+    queue.enqueueReadBuffer(bufferC, CL_TRUE, 0, sizeC * sizeof(float), hostC_gpu.data());
+    const bool syrkCorrect = nearlyEqual(hostC_gpu, hostC_cpu, N, !cfg.mirror);
+
+    const cl_ulong fullNs = elapsedNs(fullEvent);
+    const cl_ulong syrkNs = elapsedNs(syrkEvent);
+    const cl_ulong mirrorNs = cfg.mirror ? elapsedNs(mirrorEvent) : 0;
+    const double usefulFlops = 2.0 * K * (static_cast<double>(N) * (N + 1) / 2); // distinct entries of C
+
+    std::cout << "Tiles launched:   " << tilePairs << " of " << static_cast<size_t>(tiles) * tiles << "\n\n";
+    std::cout << std::left << std::setw(14) << "kernel" << std::setw(12) << "kernel ms" << std::setw(12) << "GFLOPS"
+        << "check\n";
+    std::cout << std::left << std::setw(14) << "full" << std::setw(12) << fullNs * 1e-6 << std::setw(12) << usefulFlops / fullNs
+        << (fullCorrect ? "PASSED" : "FAILED") << "\n";
+    std::cout << std::left << std::setw(14) << "syrk" << std::setw(12) << syrkNs * 1e-6 << std::setw(12) << usefulFlops / syrkNs
+        << (syrkCorrect ? "PASSED" : "FAILED") << "\n";
+    if (cfg.mirror) {
+        std::cout << std::left << std::setw(14) << "syrk+mirror" << std::setw(12) << (syrkNs + mirrorNs) * 1e-6
+            << std::setw(12) << usefulFlops / (syrkNs + mirrorNs) << "\n";
+    }
+
+    std::cout << "\nSpeedup:          " << static_cast<double>(fullNs) / (syrkNs + mirrorNs) << "x\n";
+    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "\nResult correctness: " << (fullCorrect && syrkCorrect ? "PASSED" : "FAILED") << "\n";
+
+    std::cout << "\ndone. Symmetric rank-k update completed.\n";
+
+    return EXIT_SUCCESS;
+}
+catch (const cl::Error& e) {
+    std::cerr << "OpenCL error: " << e.what() << " (" << e.err() << ")\n";
+    return EXIT_FAILURE;
+}
+catch (const std::exception& e) {
+    std::cerr << "Standard exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+}
+catch (...) {
+    std::cerr << "Unknown error occurred.\n";
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* syrk OpenCL kernels
+*
+* Symmetric rank-k update C = A * A^T, A N x K row-major, C N x N, TILE x TILE tiles:
+*   syrk        - one work-group per tile on or above the diagonal, dimension 1 enumerates the
+*                 tiles * (tiles + 1) / 2 tile pairs; both operands are rows of A, so both tile loads
+*                 are coalesced and a diagonal tile loads A once and uses it for both operands
+*   syrk_mirror - copies the upper triangle into the lower one through a local tile
+*   syrk_full   - the same tile code over every tile of C: the full tiled product, for comparison
+*/
+
+/* #define TILE 16 */ /*for ocloc offline compilation*/
+
+// tile pair p -> (row tile, column tile) with rowTile <= colTile
+inline void upper_tile(uint p, uint* rowTile, uint* colTile) {
+    uint t = (uint)((sqrt(8.0f * p + 1.0f) - 1.0f) * 0.5f);
+    while (t * (t + 1) / 2 > p) --t;
+    while ((t + 1) * (t + 2) / 2 <= p) ++t;
+    *colTile = t;
+    *rowTile = p - t * (t + 1) / 2;
+}
+
+inline void syrk_tile(__global const float* A, __global float* C, uint N, uint K, uint bi, uint bj,
+                      __local float (*Ai)[TILE + 1], __local float (*Aj)[TILE + 1]) {
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    const int row = bi * TILE + ty;
+    const int col = bj * TILE + tx;
+    const int rowJ = bj * TILE + ty;   // the row of A behind column rowJ of A^T
+    const bool diagonal = (bi == bj);  // uniform across the group
+
+    // on the diagonal both operands are the same rows of A
+    __local float (*Bj)[TILE + 1] = diagonal ? Ai : Aj;
+
+    float sum = 0.0f;
+
+    const int numTiles = (K + TILE - 1) / TILE; // ceil(K / TILE)
+    for (int t = 0; t < numTiles; ++t) {
+        const int k = t * TILE;
+
+        Ai[ty][tx] = (row < N && (k + tx) < K) ? A[row * K + (k + tx)] : 0.0f;
+        if (!diagonal) {
+            Aj[ty][tx] = (rowJ < N && (k + tx) < K) ? A[rowJ * K + (k + tx)] : 0.0f;
+        }
+
+        // SYNC
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // Bj[tx][k_local] walks down a column: the padding keeps it free of bank conflicts
+        for (int k_local = 0; k_local < TILE; ++k_local) {
+            sum += Ai[ty][k_local] * Bj[tx][k_local];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < N && col < N) {
+        C[row * N + col] = sum;
+    }
+}
+
+__kernel void syrk(__global const float* A,
+                   __global float* C,
+                   const unsigned int N,
+                   const unsigned int K)
+{
+    __local float Ai[TILE][TILE + 1];
+    __local float Aj[TILE][TILE + 1];
+
+    uint bi, bj;
+    upper_tile(get_group_id(1), &bi, &bj);
+    syrk_tile(A, C, N, K, bi, bj, Ai, Aj);
+}
+
+__kernel void syrk_full(__global const float* A,
+                        __global float* C,
+                        const unsigned int N,
+                        const unsigned int K)
+{
+    __local float Ai[TILE][TILE + 1];
+    __local float Aj[TILE][TILE + 1];
+
+    syrk_tile(A, C, N, K, get_group_id(1), get_group_id(0), Ai, Aj);
+}
+
+// Same launch as syrk: tile (bi, bj) of the upper triangle is written transposed to (bj, bi)
+__kernel void syrk_mirror(__global float* C, const unsigned int N)
+{
+    __local float tile[TILE][TILE + 1];
+
+    const int tx = get_local_id(0);
+    const int ty = get_local_id(1);
+
+    uint bi, bj;
+    upper_tile(get_group_id(1), &bi, &bj);
+
+    const int row = bi * TILE + ty;
+    const int col = bj * TILE + tx;
+    if (row < N && col < N) {
+        tile[ty][tx] = C[row * N + col];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    const int mrow = bj * TILE + ty;
+    const int mcol = bi * TILE + tx;
+    if (mrow < N && mcol < N && mrow > mcol) { // strictly below the diagonal
+        C[mrow * N + mcol] = tile[tx][ty];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* topk OpenCL kernels
+*
+* Top-k of float scores by radix select, 8-bit digits from the most significant end, 4 passes:
+*   select_histogram - digit histogram of the current candidates (local privatized, as hist_local.cl)
+*   select_bucket    - one group finds the digit that holds the k-th largest key and narrows the prefix
+*   select_filter    - keys above the prefix are final, keys equal to it are the next candidates
+*   select_ties      - after the last pass the candidates all equal the k-th key: take as many as still needed
+*   sort_survivors   - bitonic sort of the k results in local memory, largest first
+*   keys_to_values   - k above SORT_CAPACITY: results unsorted, the host sorts them
+* Candidate counts live in state[], so the whole chain runs without reading anything back:
+*   state[0] prefix, state[1] prefix mask, state[2] keys still needed from the candidates,
+*   state[3] results written, state[4 + p] candidates entering pass p (state[4] = n).
+* Pass 0 reads the raw float bits; keys are mapped so that unsigned order equals float order.
+*/
+
+/* #define SORT_CAPACITY 2048 */   /*for ocloc offline compilation*/
+
+#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
+
+#define DIGITS 256
+#define PASS_SHIFT(pass) (24 - 8 * (pass))
+
+inline uint float_to_key(uint bits) {
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline float key_to_float(uint key) {
+    return as_float((key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key);
+}
+
+__kernel void select_histogram(__global const uint* keys,
+                               __global const uint* state,
+                               uint pass,
+                               __global uint* hist) {
+    __local uint subHist[DIGITS];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    for (uint d = lid; d < DIGITS; d += lsize) {
+        subHist[d] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // every candidate already matches the prefix: no filtering here
+    const uint n = state[4 + pass];
+    const uint shift = PASS_SHIFT(pass);
+    for (uint i = get_global_id(0); i < n; i += get_global_size(0)) {
+        const uint key = (pass == 0) ? float_to_key(keys[i]) : keys[i];
+        atomic_inc(&subHist[(key >> shift) & (DIGITS - 1)]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint d = lid; d < DIGITS; d += lsize) {
+        if (subHist[d] != 0) {
+            atomic_add(&hist[d], subHist[d]);
+        }
+    }
+}
+
+// One group of DIGITS work-items
+__kernel void select_bucket(__global uint* hist,
+                            __global uint* state,
+                            uint pass) {
+    __local uint above[DIGITS];
+
+    const uint d = get_local_id(0);
+    const uint count = hist[d];
+    const uint needed = state[2];
+
+    // above[d] = number of candidates whose digit is larger than d (suffix scan, Hillis-Steele)
+    above[d] = count;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (uint offset = 1; offset < DIGITS; offset *= 2) {
+        uint add = (d + offset < DIGITS) ? above[d + offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        above[d] += add;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    const uint larger = above[d] - count;
+
+    // exactly one digit holds the needed-th largest candidate
+    if (larger < needed && larger + count >= needed) {
+        const uint shift = PASS_SHIFT(pass);
+        state[0] |= d << shift;
+        state[1] |= (DIGITS - 1) << shift;
+        state[2] = needed - larger;
+    }
+    hist[d] = 0; // ready for the next pass
+}
+
+__kernel void select_filter(__global const uint* keys,
+                            __global const uint* idxIn,
+                            __global uint* state,
+                            uint pass,
+                            __global uint* keysOut,
+                            __global uint* idxOut,
+                            __global uint* topKeys,
+                            __global uint* topIdx) {
+    __local uint topCount, candCount, topBase, candBase;
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    const uint n = state[4 + pass];
+    const uint prefix = state[0];
+    const uint mask = state[1];
+
+    // rounds of one element per work-item; the loop bound is uniform across the group
+    for (uint start = get_group_id(0) * lsize; start < n; start += get_global_size(0)) {
+        const uint i = start + lid;
+        uint key = 0;
+        uint idx = 0;
+        if (i < n) {
+            key = (pass == 0) ? float_to_key(keys[i]) : keys[i];
+            idx = (pass == 0) ? i : idxIn[i];
+        }
+        const bool isTop = (i < n) && ((key & mask) > prefix);
+        const bool isCand = (i < n) && ((key & mask) == prefix);
+
+        if (lid == 0) {
+            topCount = 0;
+            candCount = 0;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // local slots first, then one global atomic per group and round
+        uint slot = 0;
+        if (isTop) slot = atomic_inc(&topCount);
+        if (isCand) slot = atomic_inc(&candCount);
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (lid == 0) {
+            topBase = (topCount != 0) ? atomic_add(&state[3], topCount) : 0;
+            candBase = (candCount != 0) ? atomic_add(&state[5 + pass], candCount) : 0;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (isTop) {
+            topKeys[topBase + slot] = key;
+            topIdx[topBase + slot] = idx;
+        }
+        if (isCand) {
+            keysOut[candBase + slot] = key;
+            idxOut[candBase + slot] = idx;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
+
+// The last candidates are all equal to the k-th key; results so far hold k - needed keys
+__kernel void select_ties(__global const uint* keys,
+                          __global const uint* idxIn,
+                          __global const uint* state,
+                          uint k,
+                          __global uint* topKeys,
+                          __global uint* topIdx) {
+    const uint needed = state[2];
+    for (uint i = get_global_id(0); i < needed; i += get_global_size(0)) {
+        topKeys[k - needed + i] = keys[i];
+        topIdx[k - needed + i] = idxIn[i];
+    }
+}
+
+// a goes first: larger key, or the same key with the smaller index
+inline bool before(uint keyA, uint idxA, uint keyB, uint idxB) {
+    return keyA > keyB || (keyA == keyB && idxA < idxB);
+}
+
+// One group; k <= SORT_CAPACITY (a power of two), padded with the smallest key
+__kernel void sort_survivors(__global const uint* topKeys,
+                             __global const uint* topIdx,
+                             uint k,
+                             __global float* values,
+                             __global uint* indices) {
+    __local uint lkeys[SORT_CAPACITY];
+    __local uint lidx[SORT_CAPACITY];
+
+    const uint lid = get_local_id(0);
+    const uint lsize = get_local_size(0);
+    for (uint i = lid; i < SORT_CAPACITY; i += lsize) {
+        lkeys[i] = (i < k) ? topKeys[i] : 0;
+        lidx[i] = (i < k) ? topIdx[i] : UINT_MAX;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint size = 2; size <= SORT_CAPACITY; size *= 2) {
+        for (uint stride = size / 2; stride > 0; stride /= 2) {
+            for (uint t = lid; t < SORT_CAPACITY / 2; t += lsize) {
+                const uint a = 2 * t - (t & (stride - 1));
+                const uint b = a + stride;
+                const bool firstHalf = (a & size) == 0; // sorts largest first, the other half smallest first
+                const bool bFirst = before(lkeys[b], lidx[b], lkeys[a], lidx[a]);
+                if (bFirst == firstHalf) {
+                    uint key = lkeys[a];
+                    uint idx = lidx[a];
+                    lkeys[a] = lkeys[b];
+                    lidx[a] = lidx[b];
+                    lkeys[b] = key;
+                    lidx[b] = idx;
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+
+    for (uint i = lid; i < k; i += lsize) {
+        values[i] = key_to_float(lkeys[i]);
+        indices[i] = lidx[i];
+    }
+}
+
+__kernel void keys_to_values(__global const uint* topKeys,
+                             __global const uint* topIdx,
+                             uint k,
+                             __global float* values,
+                             __global uint* indices) {
+    const uint i = get_global_id(0);
+    if (i < k) {
+        values[i] = key_to_float(topKeys[i]);
+        indices[i] = topIdx[i];
+    }
+}
\ No newline at end of file
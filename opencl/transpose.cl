@@ -0,0 +1,107 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+*
+* transpose OpenCL kernels
+*
+* Row-major float matrices, tiles of TILE_DIM x TILE_DIM, work-groups of TILE_DIM x BLOCK_ROWS
+* (every work-item moves TILE_DIM / BLOCK_ROWS elements):
+*   transpose_naive   - reference: coalesced reads, writes strided by the row count
+*   transpose         - out-of-place rows x cols -> cols x rows through a local tile, both sides coalesced
+*   transpose_inplace - square n x n; one group per tile pair on or above the diagonal swaps both tiles
+* Local tiles are TILE_DIM + 1 wide: reading a tile column then touches TILE_DIM different banks.
+*/
+
+/* #define TILE_DIM 32 */   /*for ocloc offline compilation*/
+/* #define BLOCK_ROWS 8 */
+
+__kernel void transpose_naive(__global const float* in,
+                              __global float* out,
+                              uint rows,
+                              uint cols) {
+    const uint x = get_group_id(0) * TILE_DIM + get_local_id(0);
+    const uint y = get_group_id(1) * TILE_DIM + get_local_id(1);
+    for (uint j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        if (x < cols && y + j < rows) {
+            out[x * rows + (y + j)] = in[(y + j) * cols + x];
+        }
+    }
+}
+
+__kernel void transpose(__global const float* in,
+                        __global float* out,
+                        uint rows,
+                        uint cols) {
+    __local float tile[TILE_DIM][TILE_DIM + 1];
+
+    const uint tx = get_local_id(0);
+    const uint ty = get_local_id(1);
+
+    // read a tile of rows: neighbouring work-items read neighbouring columns
+    uint x = get_group_id(0) * TILE_DIM + tx;
+    uint y = get_group_id(1) * TILE_DIM + ty;
+    for (uint j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        if (x < cols && y + j < rows) {
+            tile[ty + j][tx] = in[(y + j) * cols + x];
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // write the mirrored tile: the transpose happens in local memory, global writes stay contiguous
+    x = get_group_id(1) * TILE_DIM + tx;
+    y = get_group_id(0) * TILE_DIM + ty;
+    for (uint j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        if (x < rows && y + j < cols) {
+            out[(y + j) * rows + x] = tile[tx][ty + j];
+        }
+    }
+}
+
+// Launched with one group per tile pair: dimension 1 enumerates the tnum * (tnum + 1) / 2 pairs
+__kernel void transpose_inplace(__global float* m, uint n) {
+    __local float tileA[TILE_DIM][TILE_DIM + 1];
+    __local float tileB[TILE_DIM][TILE_DIM + 1];
+
+    const uint tx = get_local_id(0);
+    const uint ty = get_local_id(1);
+
+    // pair p -> tile (by, bx) with bx <= by, rows of the lower triangle laid out one after another
+    const uint p = get_group_id(1);
+    uint by = (uint)((sqrt(8.0f * p + 1.0f) - 1.0f) * 0.5f);
+    while (by * (by + 1) / 2 > p) --by;
+    while ((by + 1) * (by + 2) / 2 <= p) ++by;
+    const uint bx = p - by * (by + 1) / 2;
+    const bool diagonal = (bx == by); // uniform across the group
+
+    for (uint j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        const uint row = by * TILE_DIM + ty + j;
+        const uint col = bx * TILE_DIM + tx;
+        if (row < n && col < n) {
+            tileA[ty + j][tx] = m[row * n + col];
+        }
+        if (!diagonal) {
+            const uint rowB = bx * TILE_DIM + ty + j;
+            const uint colB = by * TILE_DIM + tx;
+            if (rowB < n && colB < n) {
+                tileB[ty + j][tx] = m[rowB * n + colB];
+            }
+        }
+    }
+    // both tiles are in local memory before either is overwritten
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        const uint row = bx * TILE_DIM + ty + j;
+        const uint col = by * TILE_DIM + tx;
+        if (row < n && col < n) {
+            m[row * n + col] = tileA[tx][ty + j];
+        }
+        if (!diagonal) {
+            const uint rowB = by * TILE_DIM + ty + j;
+            const uint colB = bx * TILE_DIM + tx;
+            if (rowB < n && colB < n) {
+                m[rowB * n + colB] = tileB[tx][ty + j];
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -109,8 +109,10 @@ int main() try {
     kernel.setArg(2, bufferC);
     kernel.setArg(3, static_cast<cl_uint>(N));
 
-    cl::NDRange globalSize(N);
-    cl::NDRange localSize(256);
+    // the global size must be a multiple of the local size: round up, the kernel checks id < n
+    constexpr size_t LocalSize = 256;
+    cl::NDRange globalSize((N + LocalSize - 1) / LocalSize * LocalSize);
+    cl::NDRange localSize(LocalSize);
     queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize);
 
     // Device to Host
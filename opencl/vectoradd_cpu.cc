@@ -3,16 +3,22 @@
 * License: GNU GPL v3
 * **
 * An example of OpenCL offloading compute on both GPU and CPU.
+* Each device runs the one-float-per-work-item vector_add and vector_add_vec, which reads floatN with
+* N = CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT of that device in a grid-stride loop over
+* compute units x GROUPS_PER_CU work-groups, plus a scalar tail for the last n % N elements.
 *
 * ICPX: icpx vectoradd_cpu.cc -o vectoradd_cpu.exe -O2 -lOpenCL
 */
 
 #include <iostream>
+#include <iomanip>
 #include <vector>
 #include <cstdlib>
 #include <memory>
 #include <string>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 #define CL_HPP_TARGET_OPENCL_VERSION 200
 #define CL_HPP_MINIMUM_OPENCL_VERSION 120
@@ -31,9 +37,32 @@ __kernel void vector_add(__global const float* A,
         C[id] = A[id] + B[id];
     }
 }
+
+// VEC floats per load, FLOATN the matching type (float for VEC 1); buffers are aligned far beyond it
+__kernel void vector_add_vec(__global const float* A,
+                             __global const float* B,
+                             __global float* C,
+                             const unsigned int n) {
+    __global const FLOATN* a = (__global const FLOATN*)A;
+    __global const FLOATN* b = (__global const FLOATN*)B;
+    __global FLOATN* c = (__global FLOATN*)C;
+
+    const unsigned int vecs = n / VEC;
+    for (unsigned int i = get_global_id(0); i < vecs; i += get_global_size(0)) {
+        c[i] = a[i] + b[i];
+    }
+
+    // scalar tail: fewer than VEC elements, one per work-item
+    const unsigned int t = vecs * VEC + get_global_id(0);
+    if (t < n) {
+        C[t] = A[t] + B[t];
+    }
+}
 )";
 // OpenCL
 
+constexpr unsigned int GROUPS_PER_CU = 8; // persistent groups per compute unit for vector_add_vec
+
 cl::Device findDevice(cl_device_type type, const std::string& typeName) {
     std::vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
@@ -60,15 +89,115 @@ cl::Device findDevice(cl_device_type type, const std::string& typeName) {
     throw std::runtime_error("No suitable " + typeName + " device found.");
 }
 
+cl_ulong elapsedNs(const cl::Event& event) {
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+
+// Baseline vector_add as before: wall time covers buffers, build, kernel and copy back
+struct DeviceRun {
+    long wallTimeMs = 0;
+    long kernelTimeMs = 0;
+    std::vector<float> result;
+    bool correct = true;        // both kernels match A + B
+};
+
+// Runs the baseline, then both kernels again for the per-kernel table, one row per kernel
+DeviceRun benchmark(const cl::Device& device, const std::string& label,
+    const std::vector<float>& hostA, const std::vector<float>& hostB) {
+    const size_t N = hostA.size();
+    DeviceRun run;
+
+    cl_uint width = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT>();
+    if (width != 2 && width != 4 && width != 8 && width != 16) width = 1;
+    const std::string floatN = width == 1 ? "float" : "float" + std::to_string(width);
+
+    const size_t computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    const size_t groupSize = std::min<size_t>(256, device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    const size_t vecs = N / width;
+    const size_t groups = std::clamp<size_t>((vecs + groupSize - 1) / groupSize, 1, computeUnits * GROUPS_PER_CU);
+
+    // one float per work-item: round up to whole groups, the kernel checks id < n
+    const cl::NDRange scalarGlobal((N + groupSize - 1) / groupSize * groupSize);
+    const cl::NDRange vecGlobal(groups * groupSize);
+    const cl::NDRange localSize(groupSize);
+
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, cl::QueueProperties::Profiling);
+
+    auto wallStart = std::chrono::high_resolution_clock::now();
+
+    cl::Buffer bufA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, N * sizeof(float), const_cast<float*>(hostA.data()));
+    cl::Buffer bufB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, N * sizeof(float), const_cast<float*>(hostB.data()));
+    cl::Buffer bufC(context, CL_MEM_WRITE_ONLY, N * sizeof(float));
+
+    const std::string defines = "#define VEC " + std::to_string(width) + "\n#define FLOATN " + floatN + "\n";
+    cl::Program program(context, defines + vectorAddKernel);
+    program.build({ device });
+
+    auto setArgs = [&](cl::Kernel& kernel) {
+        kernel.setArg(0, bufA);
+        kernel.setArg(1, bufB);
+        kernel.setArg(2, bufC);
+        kernel.setArg(3, static_cast<cl_uint>(N));
+    };
+
+    cl::Kernel baseline(program, "vector_add");
+    setArgs(baseline);
+    cl::Event baselineEvent;
+    queue.enqueueNDRangeKernel(baseline, cl::NullRange, scalarGlobal, localSize, nullptr, &baselineEvent);
+    queue.finish();
+
+    run.result.resize(N);
+    cl::copy(queue, bufC, run.result.begin(), run.result.end());
+
+    auto wallEnd = std::chrono::high_resolution_clock::now();
+    run.wallTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(wallEnd - wallStart).count();
+    run.kernelTimeMs = static_cast<long>(elapsedNs(baselineEvent) / 1'000'000.0);
+
+    const double bytes = 3.0 * N * sizeof(float); // A and B read, C written
+    std::vector<float> result(N);
+
+    for (const char* name : { "vector_add", "vector_add_vec" }) {
+        cl::Kernel kernel(program, name);
+        setArgs(kernel);
+
+        const bool vec = std::string(name) == "vector_add_vec";
+        const cl::NDRange& globalSize = vec ? vecGlobal : scalarGlobal;
+
+        cl::Event event;
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize); // warm-up
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalSize, localSize, nullptr, &event);
+        queue.finish();
+        cl::copy(queue, bufC, result.begin(), result.end());
+
+        bool ok = true;
+        for (size_t i = 0; i < N; ++i) {
+            if (result[i] != hostA[i] + hostB[i]) {
+                ok = false;
+                break;
+            }
+        }
+        run.correct = run.correct && ok;
+
+        const cl_ulong ns = elapsedNs(event);
+        const size_t workItems = vec ? groups * groupSize : (N + groupSize - 1) / groupSize * groupSize;
+        std::cout << std::left << std::setw(6) << label << std::setw(16) << name
+            << std::setw(8) << (vec ? floatN : "float")
+            << std::setw(16) << std::to_string(workItems / groupSize) + " x " + std::to_string(groupSize)
+            << std::setw(12) << ns * 1e-6 << std::setw(10) << bytes / ns << (ok ? "PASSED" : "FAILED") << "\n";
+    }
+    return run;
+}
+
 int main() try {
     // Íàéä¸ì óñòðîéñòâà
     cl::Device gpuDevice = findDevice(CL_DEVICE_TYPE_GPU, "GPU");
     cl::Device cpuDevice = findDevice(CL_DEVICE_TYPE_CPU, "CPU");
 
     std::cout << "Selected GPU: " << gpuDevice.getInfo<CL_DEVICE_NAME>() << "\n";
-    std::cout << "Selected CPU: " << cpuDevice.getInfo<CL_DEVICE_NAME>() << "\n";
+    std::cout << "Selected CPU: " << cpuDevice.getInfo<CL_DEVICE_NAME>() << "\n\n";
 
-    constexpr size_t N = 1 << 26;
+    constexpr size_t N = (1 << 26) + 3; // not a multiple of any vector width: the tail runs too
     std::vector<float> hostA(N);
     std::vector<float> hostB(N);
     for (size_t i = 0; i < N; ++i) {
@@ -76,75 +205,19 @@ int main() try {
         hostB[i] = static_cast<float>(i * 2);
     }
 
-    cl::Context gpuContext(gpuDevice);
-    cl::CommandQueue gpuQueue(gpuContext, gpuDevice, cl::QueueProperties::Profiling);
-
-    auto gpuWallStart = std::chrono::high_resolution_clock::now();
+    std::cout << std::left << std::setw(6) << "dev" << std::setw(16) << "kernel" << std::setw(8) << "type"
+        << std::setw(16) << "groups x size" << std::setw(12) << "kernel ms" << std::setw(10) << "GB/s" << "check\n";
 
-    cl::Buffer gpuBufA(gpuContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        N * sizeof(float), hostA.data());
-    cl::Buffer gpuBufB(gpuContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        N * sizeof(float), hostB.data());
-    cl::Buffer gpuBufC(gpuContext, CL_MEM_WRITE_ONLY, N * sizeof(float));
+    const DeviceRun gpu = benchmark(gpuDevice, "GPU", hostA, hostB);
+    const DeviceRun cpu = benchmark(cpuDevice, "CPU", hostA, hostB);
 
-    cl::Program gpuProgram(gpuContext, vectorAddKernel);
-    gpuProgram.build({ gpuDevice });
-    cl::Kernel gpuKernel(gpuProgram, "vector_add");
-    gpuKernel.setArg(0, gpuBufA);
-    gpuKernel.setArg(1, gpuBufB);
-    gpuKernel.setArg(2, gpuBufC);
-    gpuKernel.setArg(3, static_cast<cl_uint>(N));
-
-    cl::Event gpuEvent;
-    cl::NDRange globalSize(N);
-    gpuQueue.enqueueNDRangeKernel(gpuKernel, cl::NullRange, globalSize, cl::NullRange, nullptr, &gpuEvent);
-    gpuQueue.finish();
-
-    std::vector<float> gpuResult(N);
-    cl::copy(gpuQueue, gpuBufC, gpuResult.begin(), gpuResult.end());
-
-    auto gpuWallEnd = std::chrono::high_resolution_clock::now();
-    long gpuWallTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(gpuWallEnd - gpuWallStart).count();
-
-    cl_ulong gpuStart = gpuEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>();
-    cl_ulong gpuEnd = gpuEvent.getProfilingInfo<CL_PROFILING_COMMAND_END>();
-    long gpuKernelTimeMs = (gpuEnd - gpuStart) / 1'000'000.0;
-
-    cl::Context cpuContext(cpuDevice);
-    cl::CommandQueue cpuQueue(cpuContext, cpuDevice, cl::QueueProperties::None);
-
-    auto cpuWallStart = std::chrono::high_resolution_clock::now();
-
-    cl::Buffer cpuBufA(cpuContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        N * sizeof(float), hostA.data());
-    cl::Buffer cpuBufB(cpuContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        N * sizeof(float), hostB.data());
-    cl::Buffer cpuBufC(cpuContext, CL_MEM_WRITE_ONLY, N * sizeof(float));
-
-    cl::Program cpuProgram(cpuContext, vectorAddKernel);
-    cpuProgram.build({ cpuDevice });
-    cl::Kernel cpuKernel(cpuProgram, "vector_add");
-    cpuKernel.setArg(0, cpuBufA);
-    cpuKernel.setArg(1, cpuBufB);
-    cpuKernel.setArg(2, cpuBufC);
-    cpuKernel.setArg(3, static_cast<cl_uint>(N));
-
-    cpuQueue.enqueueNDRangeKernel(cpuKernel, cl::NullRange, globalSize, cl::NullRange);
-    cpuQueue.finish();
-
-    std::vector<float> cpuResult(N);
-    cl::copy(cpuQueue, cpuBufC, cpuResult.begin(), cpuResult.end());
-
-    auto cpuWallEnd = std::chrono::high_resolution_clock::now();
-    long cpuTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuWallEnd - cpuWallStart).count();
-    
-    std::cout << "GPU wall time:    " << gpuWallTimeMs << " ms\n";
-    std::cout << "GPU kernel time:  " << gpuKernelTimeMs << " ms\n";
-    std::cout << "CPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "\nGPU wall time:    " << gpu.wallTimeMs << " ms\n";
+    std::cout << "GPU kernel time:  " << gpu.kernelTimeMs << " ms\n";
+    std::cout << "CPU time:         " << cpu.wallTimeMs << " ms\n";
 
     bool match = true;
     for (size_t i = 0; i < std::min(N, size_t(1000)); ++i) {
-        if (std::abs(gpuResult[i] - cpuResult[i]) > 1e-4f) {
+        if (std::abs(gpu.result[i] - cpu.result[i]) > 1e-4f) {
             match = false;
             break;
         }
@@ -152,6 +225,9 @@ int main() try {
     if (!match) {
         std::cerr << "Warning: CPU and GPU results differ!\n";
     }
+    if (!gpu.correct || !cpu.correct) {
+        std::cerr << "Warning: device results differ from A + B!\n";
+    }
 
     return EXIT_SUCCESS;
 }
@@ -167,4 +243,3 @@ catch (...) {
     std::cerr << "Unknown error occurred.\n";
     return EXIT_FAILURE;
 }
-
@@ -0,0 +1,262 @@
+/*
+* CPU-GPU-compute examples
+* License: GNU GPL v3
+* **
+* A SYCL application for parallel reductions with sycl::reduction: sum, min, max, argmax and dot.
+* The SYCL runtime picks the strategy (sub-group, local-memory tree, atomics); compare with opencl/reduce.cc.
+*
+* ICPX:    icpx sycl_reduce.cc -o sycl_reduce.exe -fsycl -std=c++20
+* Usage:   sycl_reduce.exe -size=67108864 -type=double
+*/
+
+#include <sycl/sycl.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <string_view>
+#include <limits>
+#include <type_traits>
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <cmath>
+
+struct Config {
+    unsigned int N = 1 << 26;
+    bool useDouble = false;
+};
+
+Config parseArgs(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("-size=")) {
+            auto res = std::from_chars(arg.data() + 6, arg.data() + arg.size(), cfg.N);
+            if (res.ec != std::errc{} || cfg.N == 0) {
+                std::cerr << "Invalid -size value\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg.starts_with("-type=")) {
+            std::string_view type = arg.substr(6);
+            if (type == "float") cfg.useDouble = false;
+            else if (type == "double") cfg.useDouble = true;
+            else {
+                std::cerr << "Invalid -type value (float|double)\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cfg;
+}
+
+template<typename T>
+void rand_init(std::vector<T>& v) {
+    static std::mt19937_64 gen(42);
+    std::uniform_real_distribution<T> dist(0, 1);
+    for (auto& x : v) x = dist(gen);
+}
+
+// Argmax as a user-defined reduction: ties go to the smaller index, so the result is the first maximum
+template<typename T>
+struct MaxLoc {
+    T value;
+    unsigned int index;
+};
+
+template<typename T>
+struct MaxLocOp {
+    MaxLoc<T> operator()(const MaxLoc<T>& a, const MaxLoc<T>& b) const {
+        return (b.value > a.value || (b.value == a.value && b.index < a.index)) ? b : a;
+    }
+};
+
+double elapsedMs(const sycl::event& event) {
+    uint64_t start_ns = event.get_profiling_info<sycl::info::event_profiling::command_start>();
+    uint64_t end_ns = event.get_profiling_info<sycl::info::event_profiling::command_end>();
+    return (end_ns - start_ns) * 1e-6;
+}
+
+template<typename T>
+int run_reduce(const Config& cfg, const sycl::device& device) {
+    const unsigned int N = cfg.N;
+    const size_t bytes = static_cast<size_t>(N) * sizeof(T);
+
+    std::vector<T> hostX(N);
+    std::vector<T> hostY(N);
+    rand_init(hostX);
+    rand_init(hostY);
+
+    sycl::queue q(device, sycl::property::queue::enable_profiling{});
+
+    sycl::buffer<T, 1> bufX(hostX.data(), sycl::range<1>(N));
+    sycl::buffer<T, 1> bufY(hostY.data(), sycl::range<1>(N));
+    sycl::buffer<T, 1> bufCopy{ sycl::range<1>(N) };
+    sycl::buffer<T, 1> bufSum{ sycl::range<1>(1) };
+    sycl::buffer<T, 1> bufMin{ sycl::range<1>(1) };
+    sycl::buffer<T, 1> bufMax{ sycl::range<1>(1) };
+    sycl::buffer<MaxLoc<T>, 1> bufArgMax{ sycl::range<1>(1) };
+    sycl::buffer<T, 1> bufDot{ sycl::range<1>(1) };
+
+    // Reference bandwidth: a device-side copy reads and writes every byte once
+    sycl::event copyEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        auto accCopy = bufCopy.template get_access<sycl::access::mode::discard_write>(h);
+        h.copy(accX, accCopy);
+        });
+    copyEvent.wait();
+    const double copyGBs = 2.0 * bytes / (elapsedMs(copyEvent) * 1e6);
+    std::cout << "Copy bandwidth:   " << copyGBs << " GB/s\n\n";
+
+    const auto init = sycl::property::reduction::initialize_to_identity{};
+
+    sycl::event sumEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        auto red = sycl::reduction(bufSum, h, sycl::plus<T>(), init);
+        h.parallel_for(sycl::range<1>(N), red, [=](sycl::id<1> i, auto& sum) {
+            sum.combine(accX[i]);
+            });
+        });
+
+    sycl::event minEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        auto red = sycl::reduction(bufMin, h, sycl::minimum<T>(), init);
+        h.parallel_for(sycl::range<1>(N), red, [=](sycl::id<1> i, auto& vmin) {
+            vmin.combine(accX[i]);
+            });
+        });
+
+    sycl::event maxEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        auto red = sycl::reduction(bufMax, h, sycl::maximum<T>(), init);
+        h.parallel_for(sycl::range<1>(N), red, [=](sycl::id<1> i, auto& vmax) {
+            vmax.combine(accX[i]);
+            });
+        });
+
+    sycl::event argMaxEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        const MaxLoc<T> identity{ -std::numeric_limits<T>::infinity(), std::numeric_limits<unsigned int>::max() };
+        auto red = sycl::reduction(bufArgMax, h, identity, MaxLocOp<T>(), init);
+        h.parallel_for(sycl::range<1>(N), red, [=](sycl::id<1> i, auto& best) {
+            best.combine(MaxLoc<T>{ accX[i], static_cast<unsigned int>(i[0]) });
+            });
+        });
+
+    sycl::event dotEvent = q.submit([&](sycl::handler& h) {
+        auto accX = bufX.template get_access<sycl::access::mode::read>(h);
+        auto accY = bufY.template get_access<sycl::access::mode::read>(h);
+        auto red = sycl::reduction(bufDot, h, sycl::plus<T>(), init);
+        h.parallel_for(sycl::range<1>(N), red, [=](sycl::id<1> i, auto& dot) {
+            dot.combine(accX[i] * accY[i]);
+            });
+        });
+
+    q.wait_and_throw();
+
+    // Device to Host: one value per reduction
+    const T gpuSum = bufSum.get_host_access()[0];
+    const T gpuMin = bufMin.get_host_access()[0];
+    const T gpuMax = bufMax.get_host_access()[0];
+    const MaxLoc<T> gpuArgMax = bufArgMax.get_host_access()[0];
+    const T gpuDot = bufDot.get_host_access()[0];
+
+    // CPU reference: sums in double, min/max/argmax exact in any order
+    auto cpuStart = std::chrono::high_resolution_clock::now();
+    double cpuSum = 0.0;
+    double cpuDot = 0.0;
+    for (unsigned int i = 0; i < N; ++i) {
+        cpuSum += hostX[i];
+        cpuDot += static_cast<double>(hostX[i]) * hostY[i];
+    }
+    auto [minIt, maxIt] = std::minmax_element(hostX.begin(), hostX.end());
+    auto firstMaxIt = std::max_element(hostX.begin(), hostX.end());
+    auto cpuEnd = std::chrono::high_resolution_clock::now();
+    long cpuTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(cpuEnd - cpuStart).count();
+
+    const double tolerance = std::is_same_v<T, double> ? 1e-9 : 1e-4;
+    const bool correct = std::abs(gpuSum - cpuSum) <= tolerance * cpuSum
+        && std::abs(gpuDot - cpuDot) <= tolerance * cpuDot
+        && gpuMin == *minIt && gpuMax == *maxIt
+        && gpuArgMax.value == *firstMaxIt
+        && gpuArgMax.index == static_cast<unsigned int>(firstMaxIt - hostX.begin());
+
+    auto report = [&](const char* name, const std::string& result, const sycl::event& event, size_t bytesRead) {
+        const double ms = elapsedMs(event);
+        const double gbs = bytesRead / (ms * 1e6);
+        std::cout << std::left << std::setw(8) << name << std::setw(18) << result
+            << std::setw(12) << ms << std::setw(10) << gbs
+            << static_cast<int>(100.0 * gbs / copyGBs) << "%\n";
+    };
+    std::cout << std::left << std::setw(8) << "op" << std::setw(18) << "result"
+        << std::setw(12) << "kernel ms" << std::setw(10) << "GB/s" << "of copy\n";
+    report("sum", std::to_string(gpuSum), sumEvent, bytes);
+    report("min", std::to_string(gpuMin), minEvent, bytes);
+    report("max", std::to_string(gpuMax), maxEvent, bytes);
+    report("argmax", "[" + std::to_string(gpuArgMax.index) + "] " + std::to_string(gpuArgMax.value), argMaxEvent, bytes);
+    report("dot", std::to_string(gpuDot), dotEvent, 2 * bytes);
+
+    std::cout << "\nCPU time:         " << cpuTimeMs << " ms\n";
+    std::cout << "Result correctness: " << (correct ? "PASSED" : "FAILED") << "\n";
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Config cfg = parseArgs(argc, argv);
+
+        std::cout << "Input size: " << cfg.N << "\n";
+        std::cout << "Element type: " << (cfg.useDouble ? "double" : "float") << "\n\n";
+
+        sycl::device selectedDevice;
+        bool found = false;
+        for (const auto& platform : sycl::platform::get_platforms()) {
+            for (const auto& device : platform.get_devices()) {
+                if (device.is_gpu() && device.get_info<sycl::info::device::max_compute_units>() > 0) {
+                    selectedDevice = device;
+                    found = true;
+                    break;
+                }
+            }
+            if (found) break;
+        }
+        if (!found) {
+            std::cerr << "No suitable GPU device found.\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "Selected GPU: " << selectedDevice.get_info<sycl::info::device::name>() << "\n\n";
+
+        if (cfg.useDouble && !selectedDevice.has(sycl::aspect::fp64)) {
+            std::cerr << "Device has no double precision support.\n";
+            return EXIT_FAILURE;
+        }
+
+        int status = cfg.useDouble ? run_reduce<double>(cfg, selectedDevice)
+                                   : run_reduce<float>(cfg, selectedDevice);
+        std::cout << "\ndone. Reductions computed.\n";
+        return status;
+    }
+    catch (const sycl::exception& e) {
+        std::cerr << "SYCL exception: " << e.what() << " (" << e.code() << ")\n";
+        return EXIT_FAILURE;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Standard exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch (...) {
+        std::cerr << "Unknown error occurred.\n";
+        return EXIT_FAILURE;
+    }
+}
\ No newline at end of file